@@ -43,8 +43,10 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QPdfBookmarkModel>
+#include <QPdfDiskCache>
 #include <QPdfDocument>
 #include <QPdfPageNavigation>
+#include <QPdfRenderCache>
 #include <QtMath>
 #include <QPrinter>
 #include <QPrintDialog>
@@ -63,6 +65,8 @@ MainWindow::MainWindow(QWidget *parent)
     , m_zoomSelector(new ZoomSelector(this))
     , m_pageSelector(new PageSelector(this))
     , m_document(new QPdfDocument(this))
+    , m_renderCache(new QPdfRenderCache(m_document, this))
+    , m_diskCache(new QPdfDiskCache(m_document, this))
 {
     ui->setupUi(this);
     m_zoomSelector->setMaximumWidth(150);
@@ -84,9 +88,12 @@ MainWindow::MainWindow(QWidget *parent)
 
     ui->tabWidget->setCurrentIndex(1);
     ui->pagesView->setDocument(m_document);
+    ui->pagesView->setRenderCache(m_renderCache);
+    ui->pagesView->setDiskCache(m_diskCache);
     connect(ui->pagesView, SIGNAL(buttonClicked(int)), this, SLOT(thumbnailClicked(int)));
 
     ui->pdfView->setDocument(m_document);
+    ui->pdfView->setRenderCache(m_renderCache);
 
     connect(ui->pdfView, &QPdfView::zoomFactorChanged,
             m_zoomSelector, &ZoomSelector::setZoomFactor);
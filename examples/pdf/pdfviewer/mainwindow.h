@@ -48,7 +48,9 @@ namespace Ui {
 class MainWindow;
 }
 
+class QPdfDiskCache;
 class QPdfDocument;
+class QPdfRenderCache;
 class QPdfView;
 QT_END_NAMESPACE
 
@@ -100,6 +102,8 @@ private:
     PageSelector *m_pageSelector;
 
     QPdfDocument *m_document;
+    QPdfRenderCache *m_renderCache;
+    QPdfDiskCache *m_diskCache;
     int m_rotation = 0;
 
     void setRotation(int rotation);
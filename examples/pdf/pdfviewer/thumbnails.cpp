@@ -115,7 +115,7 @@ void Thumbnails::scrollContentsBy(int dx, int dy)
  *
  * m_heigth is set to the total length of all buttons and the spacing before, after and between the buttons
  *
- * If the new width of the buttons is greater than m_imageSize, all thumbnails are rendered again and m_imageSize is set
+ * If the new width of the buttons is greater than m_imageSize, all thumbnails are loaded again and m_imageSize is set
  * to the new value. The images are not rendered if the icons already got rendered in a larger size because they just
  * get scaled down to the required size. This does not work the other way around, due to the way Qt handles icons.
  */
@@ -135,14 +135,12 @@ void Thumbnails::resizeButtons()
         QPushButton* button = list.value(i);
         button->setGeometry(posX, posY, width, height);
         posY += height + m_spacing;
-        if (m_imageSize < width) {
-            QImage image = m_document->render(i, size);
-            button->setIcon(QIcon(QPixmap::fromImage(image)));
-        }
         button->setIconSize(size);
     }
     if (m_imageSize < width) {
         m_imageSize = width;
+        m_iconSize = size;
+        loadIcons();
     }
     m_height = m_spacing + (m_document->pageCount() * (height + m_spacing));
 
@@ -151,6 +149,61 @@ void Thumbnails::resizeButtons()
     d->calculateViewport();
 }
 
+/*!
+ * Loads the icons of all buttons in m_iconSize.
+ *
+ * With a disk cache the icons are only loaded once it knows the fingerprint of m_document, so that
+ * thumbnails stored in an earlier session are shown instead of being rendered again. This slot is
+ * therefore also called when the fingerprint has been computed.
+ */
+void Thumbnails::loadIcons()
+{
+    if (m_iconSize.isEmpty())
+        return;
+    if (m_diskCache && m_diskCache->fingerprint().isEmpty())
+        return;
+
+    for (int i = 0; i < m_document->pageCount(); i++)
+        loadIcon(i);
+}
+
+/*!
+ * Sets the icon of the button of \a page. The image is requested from the disk cache if it is stored there,
+ * and rendered otherwise. Rendered images are stored in the disk cache for the next time the document is opened.
+ */
+void Thumbnails::loadIcon(int page)
+{
+    if (m_diskCache && m_diskCache->requestImage(page, m_iconSize) != 0)
+        return;
+
+    QImage image = m_renderCache ? m_renderCache->render(page, m_iconSize) : m_document->render(page, m_iconSize);
+    if (m_diskCache)
+        m_diskCache->insert(page, m_iconSize, image);
+
+    QPushButton *button = findChildren<QPushButton*>().value(page);
+    if (button)
+        button->setIcon(QIcon(QPixmap::fromImage(image)));
+}
+
+/*!
+ * Sets the icon of the button of \a page to \a image, which has been read from the disk cache in \a imageSize.
+ * Images of an outdated size are ignored, and the page is rendered if the image could not be read.
+ */
+void Thumbnails::iconLoaded(int page, QSize imageSize, const QImage &image)
+{
+    if (imageSize != m_iconSize)
+        return;
+
+    if (image.isNull()) {
+        loadIcon(page);
+        return;
+    }
+
+    QPushButton *button = findChildren<QPushButton*>().value(page);
+    if (button)
+        button->setIcon(QIcon(QPixmap::fromImage(image)));
+}
+
 /*!
  * Clears all of the old buttons and creates new ones if there is at least one page.
  *
@@ -164,6 +217,7 @@ void Thumbnails::createButtons()
 {
     clearButtons();
     m_imageSize = 0;
+    m_iconSize = QSize();
     if (m_document->pageCount() == 0) {
         verticalScrollBar()->setRange(0, 0);
         return;
@@ -200,6 +254,32 @@ void Thumbnails::setDocument(QPdfDocument *document)
     connect(m_document, SIGNAL(pageCountChanged(int)), this, SLOT(createButtons()));
 }
 
+/*!
+ * Sets m_renderCache to \a cache. The thumbnails are then rendered through the cache,
+ * which shares them with the other views of the document.
+ */
+void Thumbnails::setRenderCache(QPdfRenderCache *cache)
+{
+    m_renderCache = cache;
+}
+
+/*!
+ * Sets m_diskCache to \a cache. Thumbnails are then stored on disk, and shown from there
+ * when the document is opened again.
+ */
+void Thumbnails::setDiskCache(QPdfDiskCache *cache)
+{
+    if (m_diskCache)
+        disconnect(m_diskCache, nullptr, this, nullptr);
+
+    m_diskCache = cache;
+
+    if (m_diskCache) {
+        connect(m_diskCache, &QPdfDiskCache::fingerprintChanged, this, &Thumbnails::loadIcons);
+        connect(m_diskCache, &QPdfDiskCache::imageLoaded, this, &Thumbnails::iconLoaded);
+    }
+}
+
 QT_END_NAMESPACE
 
 #include "moc_thumbnails.cpp"
@@ -4,6 +4,8 @@
 #include <QObject>
 #include <QtWidgets>
 #include <QPdfDocument>
+#include <QPdfRenderCache>
+#include <QPdfDiskCache>
 
 QT_BEGIN_NAMESPACE
 
@@ -16,6 +18,8 @@ public:
     explicit Thumbnails(QWidget *parent = nullptr);
     ~Thumbnails();
     void setDocument(QPdfDocument *document);
+    void setRenderCache(QPdfRenderCache *cache);
+    void setDiskCache(QPdfDiskCache *cache);
 
 signals:
     void buttonClicked(int page);
@@ -23,6 +27,7 @@ signals:
 public slots:
     void createButtons();
     void resizeButtons();
+    void loadIcons();
 
 protected:
     explicit Thumbnails(ThumbnailsPrivate &, QWidget *);
@@ -32,7 +37,12 @@ protected:
 
 private:
     void clearButtons();
+    void loadIcon(int page);
+    void iconLoaded(int page, QSize imageSize, const QImage &image);
     QPdfDocument *m_document;
+    QPdfRenderCache *m_renderCache = nullptr;
+    QPdfDiskCache *m_diskCache = nullptr;
+    QSize m_iconSize;
     int m_height;
     int m_spacing;
     int m_imageSize;
@@ -24,19 +24,37 @@ msvc {
 
 SOURCES += \
     jsbridge.cpp \
+    qpdfbitmappool.cpp \
+    qpdfblockcache.cpp \
     qpdfbookmarkmodel.cpp \
+    qpdfchunkedbuffer.cpp \
+    qpdfdiskcache.cpp \
     qpdfdocument.cpp \
+    qpdfdocumentrenderoptions.cpp \
     qpdfpagenavigation.cpp \
     qpdfpagerenderer.cpp \
+    qpdfrangeloader.cpp \
+    qpdfrendercache.cpp \
+    qpdfrenderstatistics.cpp \
+    qpdfrenderprocess.cpp \
     qpdfwriter.cpp
 
 HEADERS += \
+    qpdfbitmappool_p.h \
+    qpdfblockcache_p.h \
     qpdfbookmarkmodel.h \
+    qpdfchunkedbuffer_p.h \
+    qpdfdiskcache.h \
     qpdfdocument.h \
     qpdfdocument_p.h \
     qpdfdocumentrenderoptions.h \
     qpdfnamespace.h \
     qpdfpagenavigation.h \
     qpdfpagerenderer.h \
+    qpdfrangeloader_p.h \
+    qpdfrendercache.h \
+    qpdfrenderstatistics.h \
+    qpdfrenderstatistics_p.h \
+    qpdfrenderprocess_p.h \
     qtpdfglobal.h \
     qpdfwriter.h
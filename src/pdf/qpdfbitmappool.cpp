@@ -0,0 +1,183 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfbitmappool_p.h"
+
+#include <cstdlib>
+
+QT_BEGIN_NAMESPACE
+
+// the pixel data follows the bookkeeping, aligned for any pixel format
+static const int headerSize = 32;
+
+static quint64 bufferKey(QSize size, QImage::Format format)
+{
+    return (quint64(size.width()) << 40) | (quint64(size.height()) << 16) | quint64(format);
+}
+
+QPdfBitmapPool::QPdfBitmapPool()
+    : m_ref(1)
+    , m_freeBytes(0)
+    , m_limit(0)
+{
+    Q_STATIC_ASSERT(sizeof(Buffer) <= headerSize);
+}
+
+QPdfBitmapPool::~QPdfBitmapPool()
+{
+    trimLocked(0);
+}
+
+void QPdfBitmapPool::ref()
+{
+    m_ref.ref();
+}
+
+void QPdfBitmapPool::deref()
+{
+    if (!m_ref.deref())
+        delete this;
+}
+
+qint64 QPdfBitmapPool::limit() const
+{
+    const QMutexLocker locker(&m_mutex);
+
+    return m_limit;
+}
+
+void QPdfBitmapPool::setLimit(qint64 bytes)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    m_limit = qMax(qint64(0), bytes);
+    trimLocked(m_limit);
+}
+
+void QPdfBitmapPool::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+
+    trimLocked(0);
+}
+
+QImage QPdfBitmapPool::acquire(QSize size, QImage::Format format)
+{
+    if (size.isEmpty())
+        return QImage();
+
+    const quint64 key = bufferKey(size, format);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_limit <= 0) {
+        locker.unlock();
+        return QImage(size, format);
+    }
+
+    Buffer *buffer = nullptr;
+
+    auto it = m_freeBuffers.find(key);
+    if (it != m_freeBuffers.end()) {
+        buffer = it->takeLast();
+        m_freeBytes -= buffer->bytes;
+        if (it->isEmpty())
+            m_freeBuffers.erase(it);
+    }
+
+    locker.unlock();
+
+    // same scan line alignment as QImage uses for its own buffers
+    const int bytesPerLine = ((size.width() * QImage::toPixelFormat(format).bitsPerPixel() + 31) >> 5) << 2;
+
+    if (!buffer) {
+        const qint64 bytes = qint64(bytesPerLine) * size.height();
+        void *memory = malloc(size_t(headerSize + bytes));
+        if (!memory)
+            return QImage();
+
+        buffer = static_cast<Buffer*>(memory);
+        buffer->pool = this;
+        buffer->key = key;
+        buffer->bytes = bytes;
+    }
+
+    ref();
+
+    uchar *data = reinterpret_cast<uchar*>(buffer) + headerSize;
+    return QImage(data, size.width(), size.height(), bytesPerLine, format, releaseBuffer, buffer);
+}
+
+void QPdfBitmapPool::releaseBuffer(void *info)
+{
+    Buffer *buffer = static_cast<Buffer*>(info);
+    QPdfBitmapPool *pool = buffer->pool;
+
+    pool->recycle(buffer);
+    pool->deref();
+}
+
+void QPdfBitmapPool::recycle(Buffer *buffer)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_freeBytes + buffer->bytes > m_limit) {
+        locker.unlock();
+        free(buffer);
+        return;
+    }
+
+    m_freeBuffers[buffer->key].append(buffer);
+    m_freeBytes += buffer->bytes;
+}
+
+void QPdfBitmapPool::trimLocked(qint64 limit)
+{
+    for (auto it = m_freeBuffers.begin(); it != m_freeBuffers.end() && m_freeBytes > limit; ) {
+        while (!it->isEmpty() && m_freeBytes > limit) {
+            Buffer *buffer = it->takeLast();
+            m_freeBytes -= buffer->bytes;
+            free(buffer);
+        }
+
+        if (it->isEmpty())
+            it = m_freeBuffers.erase(it);
+        else
+            ++it;
+    }
+}
+
+QT_END_NAMESPACE
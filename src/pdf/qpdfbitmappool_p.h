@@ -0,0 +1,108 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFBITMAPPOOL_P_H
+#define QPDFBITMAPPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+
+// Recycles the pixel buffers of rendered images.
+//
+// acquire() returns a QImage on a buffer owned by the pool. When the last copy of the
+// image is destroyed, the buffer goes back to a free list keyed by size and format,
+// from which the next acquire() with the same geometry is served, so rendering the
+// same sizes over and over does not allocate pixel data. Up to limit() bytes are kept
+// on the free lists; with a limit of 0 the pool is bypassed.
+//
+// Every image holds a reference to the pool, so it stays alive until the last image
+// is gone even if its owner releases it earlier.
+class QPdfBitmapPool
+{
+public:
+    QPdfBitmapPool();
+
+    void ref();
+    void deref();
+
+    qint64 limit() const;
+    void setLimit(qint64 bytes);
+
+    void clear();
+
+    QImage acquire(QSize size, QImage::Format format);
+
+private:
+    struct Buffer
+    {
+        QPdfBitmapPool *pool;
+        quint64 key;
+        qint64 bytes;
+    };
+
+    ~QPdfBitmapPool();
+    Q_DISABLE_COPY(QPdfBitmapPool)
+
+    static void releaseBuffer(void *info);
+    void recycle(Buffer *buffer);
+    void trimLocked(qint64 limit);
+
+    QAtomicInt m_ref;
+    mutable QMutex m_mutex;
+    QHash<quint64, QVector<Buffer*>> m_freeBuffers;
+    qint64 m_freeBytes;
+    qint64 m_limit;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFBITMAPPOOL_P_H
@@ -0,0 +1,188 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfblockcache_p.h"
+
+#include <QFileDevice>
+
+#ifdef Q_OS_UNIX
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+static const int defaultBlockSize = 16 * 1024;
+static const int defaultCapacity = 256;
+
+QPdfBlockCache::QPdfBlockCache()
+    : m_deviceSize(0)
+    , m_handle(-1)
+    , m_blockSize(defaultBlockSize)
+{
+    m_blocks.setMaxCost(defaultCapacity);
+}
+
+void QPdfBlockCache::setDevice(QIODevice *device, qint64 deviceSize)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    m_blocks.clear();
+    m_device = device;
+    m_deviceSize = deviceSize;
+    m_handle = -1;
+
+#ifdef Q_OS_UNIX
+    if (QFileDevice *fileDevice = qobject_cast<QFileDevice*>(device))
+        m_handle = fileDevice->handle();
+#endif
+}
+
+int QPdfBlockCache::blockSize() const
+{
+    return m_blockSize;
+}
+
+void QPdfBlockCache::setBlockSize(int size)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    if (size <= 0 || size == m_blockSize)
+        return;
+
+    m_blockSize = size;
+    m_blocks.clear();
+}
+
+int QPdfBlockCache::capacity() const
+{
+    return m_blocks.maxCost();
+}
+
+void QPdfBlockCache::setCapacity(int blocks)
+{
+    const QMutexLocker locker(&m_mutex);
+
+    m_blocks.setMaxCost(qMax(0, blocks));
+}
+
+void QPdfBlockCache::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+
+    m_blocks.clear();
+}
+
+qint64 QPdfBlockCache::read(qint64 position, char *data, qint64 size)
+{
+    if (m_blocks.maxCost() == 0)
+        return readAt(position, data, size);
+
+    qint64 bytesRead = 0;
+
+    while (bytesRead < size) {
+        const qint64 offset = position + bytesRead;
+        const qint64 block = offset / m_blockSize;
+        const qint64 offsetInBlock = offset - block * m_blockSize;
+
+        const QByteArray blockData = readBlock(block);
+        const qint64 length = qMin(size - bytesRead, blockData.size() - offsetInBlock);
+        if (length <= 0)
+            break;
+
+        memcpy(data + bytesRead, blockData.constData() + offsetInBlock, length);
+        bytesRead += length;
+
+        if (blockData.size() < m_blockSize)
+            break; // end of data
+    }
+
+    return bytesRead;
+}
+
+QByteArray QPdfBlockCache::readBlock(qint64 block)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (const QByteArray *cached = m_blocks.object(block))
+        return *cached;
+
+    const int blockSize = m_blockSize;
+    locker.unlock();
+
+    // the I/O happens without holding the lock, so other threads can be served meanwhile
+    QByteArray blockData(blockSize, Qt::Uninitialized);
+    const qint64 length = readAt(block * blockSize, blockData.data(), blockSize);
+    blockData.resize(int(qMax(qint64(0), length)));
+
+    // A short block is either the end of the device or data that has not arrived yet,
+    // only cache it in the first case.
+    locker.relock();
+    if (blockSize == m_blockSize && (length == blockSize || block * blockSize + length == m_deviceSize)) {
+        m_blocks.insert(block, new QByteArray(blockData));
+    }
+
+    return blockData;
+}
+
+qint64 QPdfBlockCache::readAt(qint64 position, char *data, qint64 size)
+{
+#ifdef Q_OS_UNIX
+    if (m_handle >= 0) {
+        qint64 bytesRead = 0;
+        while (bytesRead < size) {
+            const ssize_t result = ::pread(m_handle, data + bytesRead, size_t(size - bytesRead), off_t(position + bytesRead));
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                break;
+            bytesRead += result;
+        }
+        return bytesRead;
+    }
+#endif
+
+    const QMutexLocker locker(&m_deviceMutex);
+
+    if (!m_device || !m_device->seek(position))
+        return 0;
+
+    return qMax(qint64(0), m_device->read(data, size));
+}
+
+QT_END_NAMESPACE
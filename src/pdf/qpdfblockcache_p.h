@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFBLOCKCACHE_P_H
+#define QPDFBLOCKCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QPointer>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+
+// A cache of fixed-size, block-aligned chunks of a random access device.
+//
+// PDFium reads the same xref and object stream regions many times while loading
+// pages, so this keeps the most recently used blocks around. Blocks are fetched with
+// positional reads where the platform supports them (pread() on a QFile's descriptor),
+// otherwise with seek() and read() serialized by an internal mutex. read() is safe to
+// call from several threads at the same time.
+class Q_AUTOTEST_EXPORT QPdfBlockCache
+{
+public:
+    QPdfBlockCache();
+
+    void setDevice(QIODevice *device, qint64 deviceSize);
+
+    int blockSize() const;
+    void setBlockSize(int size);
+
+    int capacity() const;
+    void setCapacity(int blocks);
+
+    void clear();
+
+    qint64 read(qint64 position, char *data, qint64 size);
+
+private:
+    QByteArray readBlock(qint64 block);
+    qint64 readAt(qint64 position, char *data, qint64 size);
+
+    QMutex m_mutex;
+    QMutex m_deviceMutex;
+    QPointer<QIODevice> m_device;
+    qint64 m_deviceSize;
+    int m_handle;
+    int m_blockSize;
+    QCache<qint64, QByteArray> m_blocks;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFBLOCKCACHE_P_H
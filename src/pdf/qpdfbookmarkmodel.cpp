@@ -157,7 +157,7 @@ public:
         if (documentAvailable) {
             q->beginResetModel();
             m_rootNode->clear();
-            QPdfMutexLocker lock;
+            QPdfMutexLocker lock(m_document->d.data());
             appendChildNode(m_rootNode.data(), nullptr, 0, m_document->d->doc);
             lock.unlock();
             q->endResetModel();
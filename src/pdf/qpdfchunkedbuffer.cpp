@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfchunkedbuffer_p.h"
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+QPdfChunkedBuffer::QPdfChunkedBuffer()
+    : m_size(0)
+{
+}
+
+qint64 QPdfChunkedBuffer::size() const
+{
+    const QMutexLocker locker(&m_mutex);
+
+    return m_size;
+}
+
+void QPdfChunkedBuffer::append(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return;
+
+    const QMutexLocker locker(&m_mutex);
+
+    m_chunks.append(data);
+    m_offsets.append(m_size);
+    m_size += data.size();
+}
+
+void QPdfChunkedBuffer::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+
+    m_chunks.clear();
+    m_offsets.clear();
+    m_size = 0;
+}
+
+qint64 QPdfChunkedBuffer::read(qint64 position, char *data, qint64 size) const
+{
+    const QMutexLocker locker(&m_mutex);
+
+    if (position < 0 || position >= m_size)
+        return 0;
+
+    // the last chunk that starts at or before position
+    int chunk = int(std::upper_bound(m_offsets.constBegin(), m_offsets.constEnd(), position) - m_offsets.constBegin()) - 1;
+
+    qint64 bytesRead = 0;
+    while (bytesRead < size && chunk < m_chunks.size()) {
+        const QByteArray &chunkData = m_chunks.at(chunk);
+        const qint64 offsetInChunk = position + bytesRead - m_offsets.at(chunk);
+        const qint64 length = qMin(size - bytesRead, chunkData.size() - offsetInChunk);
+
+        memcpy(data + bytesRead, chunkData.constData() + offsetInChunk, size_t(length));
+        bytesRead += length;
+        ++chunk;
+    }
+
+    return bytesRead;
+}
+
+QT_END_NAMESPACE
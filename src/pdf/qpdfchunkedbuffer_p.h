@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFCHUNKEDBUFFER_P_H
+#define QPDFCHUNKEDBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QByteArray>
+#include <QMutex>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+
+// An append-only buffer for data that arrives in pieces, e.g. from a QNetworkReply.
+//
+// The appended byte arrays are kept as they are, together with the offset at which
+// each of them starts, so appending never reallocates or copies what has been
+// received so far. read() finds the first chunk with a binary search and copies
+// across chunk boundaries. All functions are safe to call from several threads.
+class Q_AUTOTEST_EXPORT QPdfChunkedBuffer
+{
+public:
+    QPdfChunkedBuffer();
+
+    qint64 size() const;
+
+    void append(const QByteArray &data);
+    void clear();
+
+    qint64 read(qint64 position, char *data, qint64 size) const;
+
+private:
+    mutable QMutex m_mutex;
+    QVector<QByteArray> m_chunks;
+    QVector<qint64> m_offsets;    // start offset of each chunk
+    qint64 m_size;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFCHUNKEDBUFFER_P_H
@@ -0,0 +1,698 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfdiskcache.h"
+
+#include "qpdfdocument_p.h"
+
+#include <private/qobject_p.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QPointer>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+static const qint64 defaultMaximumSize = 256 * 1024 * 1024;
+
+// The images are stored uncompressed, so that reading one back costs no more than the I/O.
+static const char imageFileSuffix[] = ".qpdfimg";
+static const quint32 imageFileMagic = 0x51504449; // "QPDI"
+static const quint32 imageFileVersion = 1;
+
+static QString imageFilePath(const QString &path, const QByteArray &fingerprint, int page, QSize imageSize,
+                             QPdfDocumentRenderOptions options)
+{
+    QByteArray serializedOptions;
+    QDataStream stream(&serializedOptions, QIODevice::WriteOnly);
+    stream << options;
+
+    return path + QLatin1Char('/') + QString::fromLatin1(fingerprint) + QLatin1Char('/')
+           + QString::number(page) + QLatin1Char('_')
+           + QString::number(imageSize.width()) + QLatin1Char('x') + QString::number(imageSize.height())
+           + QLatin1Char('_') + QString::fromLatin1(serializedOptions.toHex())
+           + QLatin1String(imageFileSuffix);
+}
+
+struct QPdfDiskCacheHeader
+{
+    quint32 magic;
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 format;
+    qint32 bytesPerLine;
+};
+
+// Does all the file system work of a QPdfDiskCache in a thread of its own, in the order
+// it has been requested, so that neither reads nor writes block the caller.
+class QPdfDiskCacheWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    QPdfDiskCacheWorker();
+
+    bool isStored(const QString &filePath) const;
+
+public Q_SLOTS:
+    void setPath(const QString &path);
+    void setMaximumSize(qint64 bytes);
+    void setContent(quint64 generation, const QString &fileName, const QByteArray &content);
+    void read(quint64 requestId, const QString &filePath, int page, QSize imageSize,
+              QPdfDocumentRenderOptions options);
+    void write(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options);
+    void clear();
+
+Q_SIGNALS:
+    void fingerprintComputed(quint64 generation, const QByteArray &fingerprint);
+    void imageRead(int page, QSize imageSize, const QImage &image,
+                   QPdfDocumentRenderOptions options, quint64 requestId);
+
+private:
+    void scan();
+    void evict();
+    void addToIndex(const QString &filePath);
+    void removeFromIndex(const QString &filePath);
+
+    QString m_path;
+    QByteArray m_fingerprint;   // of the document the images are written for
+    qint64 m_maximumSize;
+    qint64 m_size;  // -1 until the files in m_path have been counted
+
+    // the paths of the stored files, which the cache looks up without touching the disk
+    mutable QMutex m_indexMutex;
+    QSet<QString> m_index;
+};
+
+class QPdfDiskCachePrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QPdfDiskCache)
+
+public:
+    QPdfDiskCachePrivate();
+    ~QPdfDiskCachePrivate();
+
+    void init();
+    void updateFingerprint();
+    QString filePath(int page, QSize imageSize, QPdfDocumentRenderOptions options) const;
+
+    QPointer<QPdfDocument> m_document;
+    QMetaObject::Connection m_documentStatusConnection;
+    QByteArray m_fingerprint;
+    quint64 m_fingerprintGeneration = 0;   // identifies the latest content handed to the worker
+    QString m_path;
+    qint64 m_maximumSize = defaultMaximumSize;
+    quint64 m_requestIdCounter = 1;
+
+    QThread m_thread;
+    QPdfDiskCacheWorker *m_worker;
+};
+
+
+QPdfDiskCacheWorker::QPdfDiskCacheWorker()
+    : m_maximumSize(defaultMaximumSize)
+    , m_size(-1)
+{
+}
+
+// Can be called from any thread.
+bool QPdfDiskCacheWorker::isStored(const QString &filePath) const
+{
+    const QMutexLocker locker(&m_indexMutex);
+
+    return m_index.contains(filePath);
+}
+
+void QPdfDiskCacheWorker::setPath(const QString &path)
+{
+    m_path = path;
+    m_size = -1;
+
+    scan();
+}
+
+void QPdfDiskCacheWorker::setMaximumSize(qint64 bytes)
+{
+    m_maximumSize = bytes;
+    evict();
+}
+
+// Hashes the whole document, read from its file if it has been loaded from one, so that
+// a change anywhere in it gives the document another fingerprint.
+void QPdfDiskCacheWorker::setContent(quint64 generation, const QString &fileName, const QByteArray &content)
+{
+    m_fingerprint.clear();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!fileName.isEmpty()) {
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly) && hash.addData(&file))
+            m_fingerprint = hash.result().toHex();
+    } else if (!content.isEmpty()) {
+        hash.addData(content);
+        m_fingerprint = hash.result().toHex();
+    }
+
+    emit fingerprintComputed(generation, m_fingerprint);
+}
+
+void QPdfDiskCacheWorker::read(quint64 requestId, const QString &filePath, int page, QSize imageSize,
+                               QPdfDocumentRenderOptions options)
+{
+    QImage image;
+
+    QFile file(filePath);
+    QPdfDiskCacheHeader header;
+    if (file.open(QIODevice::ReadOnly)
+        && file.read(reinterpret_cast<char *>(&header), sizeof(header)) == qint64(sizeof(header))
+        && header.magic == imageFileMagic && header.version == imageFileVersion
+        && header.width > 0 && header.height > 0
+        && header.format > QImage::Format_Invalid && header.format < QImage::NImageFormats) {
+
+        image = QImage(header.width, header.height, QImage::Format(header.format));
+        if (image.bytesPerLine() != header.bytesPerLine
+            || file.read(reinterpret_cast<char *>(image.bits()), image.sizeInBytes()) != image.sizeInBytes())
+            image = QImage();
+    }
+
+    // the modification time orders the files for the eviction, so reading counts as a use
+    if (!image.isNull())
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    else
+        removeFromIndex(filePath);
+
+    emit imageRead(page, imageSize, image, options, requestId);
+}
+
+// The images are written for the document whose content has been set last, which is the
+// one they have been rendered from, since the worker handles everything in order.
+void QPdfDiskCacheWorker::write(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options)
+{
+    if (m_maximumSize <= 0 || m_fingerprint.isEmpty())
+        return;
+
+    scan();
+
+    const QString filePath = imageFilePath(m_path, m_fingerprint, page, imageSize, options);
+
+    const QFileInfo oldFile(filePath);
+    const qint64 oldSize = oldFile.exists() ? oldFile.size() : 0;
+
+    QDir().mkpath(oldFile.absolutePath());
+
+    QPdfDiskCacheHeader header;
+    header.magic = imageFileMagic;
+    header.version = imageFileVersion;
+    header.width = image.width();
+    header.height = image.height();
+    header.format = image.format();
+    header.bytesPerLine = image.bytesPerLine();
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes());
+    if (!file.commit())
+        return;
+
+    m_size += qint64(sizeof(header)) + image.sizeInBytes() - oldSize;
+    addToIndex(filePath);
+    evict();
+}
+
+void QPdfDiskCacheWorker::clear()
+{
+    QDirIterator it(m_path, QStringList() << QLatin1Char('*') + QLatin1String(imageFileSuffix),
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        QFile::remove(it.next());
+
+    // the directories of the documents are removed if nothing else has been put into them
+    const QStringList documentDirectories = QDir(m_path).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &documentDirectory : documentDirectories)
+        QDir(m_path).rmdir(documentDirectory);
+
+    m_size = 0;
+
+    const QMutexLocker locker(&m_indexMutex);
+    m_index.clear();
+}
+
+void QPdfDiskCacheWorker::scan()
+{
+    if (m_size >= 0)
+        return;
+
+    m_size = 0;
+
+    // the paths are put together the way QPdfDiskCachePrivate::filePath() does
+    QSet<QString> index;
+    QDirIterator it(m_path, QStringList() << QLatin1Char('*') + QLatin1String(imageFileSuffix),
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        m_size += it.fileInfo().size();
+        index.insert(m_path + QLatin1Char('/') + it.fileInfo().dir().dirName() + QLatin1Char('/') + it.fileName());
+    }
+
+    const QMutexLocker locker(&m_indexMutex);
+    m_index.swap(index);
+}
+
+// Removes the least recently used files until the cache takes up no more than 90% of its
+// maximum size, which leaves some room before the directory has to be walked again.
+void QPdfDiskCacheWorker::evict()
+{
+    scan();
+
+    if (m_size <= m_maximumSize)
+        return;
+
+    QVector<QFileInfo> files;
+    QDirIterator it(m_path, QStringList() << QLatin1Char('*') + QLatin1String(imageFileSuffix),
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        files.append(it.fileInfo());
+    }
+
+    std::sort(files.begin(), files.end(), [](const QFileInfo &lhs, const QFileInfo &rhs) {
+        return lhs.lastModified() < rhs.lastModified();
+    });
+
+    const qint64 targetSize = m_maximumSize / 10 * 9;
+    for (const QFileInfo &file : qAsConst(files)) {
+        if (m_size <= targetSize)
+            break;
+
+        if (QFile::remove(file.absoluteFilePath())) {
+            m_size -= file.size();
+            removeFromIndex(m_path + QLatin1Char('/') + file.dir().dirName() + QLatin1Char('/') + file.fileName());
+            QDir(m_path).rmdir(file.absolutePath());
+        }
+    }
+}
+
+void QPdfDiskCacheWorker::addToIndex(const QString &filePath)
+{
+    const QMutexLocker locker(&m_indexMutex);
+
+    m_index.insert(filePath);
+}
+
+void QPdfDiskCacheWorker::removeFromIndex(const QString &filePath)
+{
+    const QMutexLocker locker(&m_indexMutex);
+
+    m_index.remove(filePath);
+}
+
+
+QPdfDiskCachePrivate::QPdfDiskCachePrivate()
+    : QObjectPrivate()
+    , m_path(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/qtpdf"))
+    , m_worker(new QPdfDiskCacheWorker)
+{
+}
+
+QPdfDiskCachePrivate::~QPdfDiskCachePrivate()
+{
+    // the writes that are still queued are carried out before the thread stops
+    QMetaObject::invokeMethod(m_worker, []() { QThread::currentThread()->quit(); }, Qt::QueuedConnection);
+    m_thread.wait();
+
+    delete m_worker;
+}
+
+void QPdfDiskCachePrivate::init()
+{
+    Q_Q(QPdfDiskCache);
+
+    qRegisterMetaType<QPdfDocumentRenderOptions>();
+
+    QObject::connect(m_worker, &QPdfDiskCacheWorker::imageRead, q, &QPdfDiskCache::imageLoaded);
+    QObject::connect(m_worker, &QPdfDiskCacheWorker::fingerprintComputed, q,
+                     [this](quint64 generation, const QByteArray &fingerprint) {
+        Q_Q(QPdfDiskCache);
+
+        // the content may have changed again in the meantime
+        if (generation != m_fingerprintGeneration || fingerprint == m_fingerprint)
+            return;
+
+        m_fingerprint = fingerprint;
+        emit q->fingerprintChanged(m_fingerprint);
+    });
+
+    m_worker->moveToThread(&m_thread);
+    m_thread.start(QThread::LowPriority);
+
+    // the files that are already stored are looked up in the worker's thread
+    QMetaObject::invokeMethod(m_worker, "setPath", Qt::QueuedConnection, Q_ARG(QString, m_path));
+}
+
+// Hands the content of the document to the worker, which computes its fingerprint in the
+// background. Documents loaded from a file are read from there by the worker.
+void QPdfDiskCachePrivate::updateFingerprint()
+{
+    Q_Q(QPdfDiskCache);
+
+    ++m_fingerprintGeneration;
+
+    if (!m_fingerprint.isEmpty()) {
+        m_fingerprint.clear();
+        emit q->fingerprintChanged(m_fingerprint);
+    }
+
+    QString fileName;
+    QByteArray content;
+    if (m_document && m_document->status() == QPdfDocument::Ready) {
+        fileName = m_document->d->fileName;
+        if (fileName.isEmpty())
+            content = m_document->d->readContent();
+    }
+
+    QMetaObject::invokeMethod(m_worker, "setContent", Qt::QueuedConnection, Q_ARG(quint64, m_fingerprintGeneration),
+                              Q_ARG(QString, fileName), Q_ARG(QByteArray, content));
+}
+
+QString QPdfDiskCachePrivate::filePath(int page, QSize imageSize, QPdfDocumentRenderOptions options) const
+{
+    return imageFilePath(m_path, m_fingerprint, page, imageSize, options);
+}
+
+/*!
+    \class QPdfDiskCache
+    \since 5.11
+    \inmodule QtPdf
+
+    \brief The QPdfDiskCache class keeps rendered pages of PDF documents on disk across sessions.
+
+    A QPdfDiskCache stores images rendered from a document, such as thumbnails
+    and previews, in a directory, so that they are available at once when the
+    document is opened again. The images are identified by a fingerprint of the
+    document's contents together with the page, the requested image size and
+    the render options; a document that is opened from a different location is
+    still recognized, while a document that has been changed is not.
+
+    The fingerprint is a hash of the whole document, which is computed in the
+    background once the document is ready; fingerprintChanged() announces it.
+    Documents whose data is fetched with range requests are only partially
+    available and therefore not cached.
+
+    The images are read asynchronously with requestImage(), which delivers them
+    through the imageLoaded() signal; insert() writes them in the background as
+    well. When the files exceed maximumSize(), the least recently used ones are
+    removed.
+
+    \sa QPdfRenderCache
+*/
+
+/*!
+    Constructs a disk cache with parent object \a parent.
+*/
+QPdfDiskCache::QPdfDiskCache(QObject *parent)
+    : QObject(*new QPdfDiskCachePrivate(), parent)
+{
+    Q_D(QPdfDiskCache);
+
+    d->init();
+}
+
+/*!
+    Constructs a disk cache for \a document with parent object \a parent.
+*/
+QPdfDiskCache::QPdfDiskCache(QPdfDocument *document, QObject *parent)
+    : QObject(*new QPdfDiskCachePrivate(), parent)
+{
+    Q_D(QPdfDiskCache);
+
+    d->init();
+    setDocument(document);
+}
+
+/*!
+    Destroys the disk cache. Images that are still being written are completed first.
+*/
+QPdfDiskCache::~QPdfDiskCache()
+{
+}
+
+/*!
+    \property QPdfDiskCache::document
+    \brief the document whose pages are cached
+
+    By default, this property is \c nullptr.
+*/
+
+/*!
+    Returns the document whose pages are cached.
+*/
+QPdfDocument* QPdfDiskCache::document() const
+{
+    Q_D(const QPdfDiskCache);
+
+    return d->m_document;
+}
+
+/*!
+    Sets the \a document whose pages are cached.
+
+    The images of other documents remain in the cache.
+*/
+void QPdfDiskCache::setDocument(QPdfDocument *document)
+{
+    Q_D(QPdfDiskCache);
+
+    if (d->m_document == document)
+        return;
+
+    disconnect(d->m_documentStatusConnection);
+
+    d->m_document = document;
+    d->updateFingerprint();
+    emit documentChanged(d->m_document);
+
+    if (d->m_document)
+        d->m_documentStatusConnection = connect(d->m_document, &QPdfDocument::statusChanged, this, [d]() { d->updateFingerprint(); });
+}
+
+/*!
+    \property QPdfDiskCache::path
+    \brief the directory the images are stored in
+
+    By default, this is the directory \c qtpdf in the application's
+    QStandardPaths::CacheLocation.
+*/
+
+/*!
+    Returns the directory the images are stored in.
+*/
+QString QPdfDiskCache::path() const
+{
+    Q_D(const QPdfDiskCache);
+
+    return d->m_path;
+}
+
+/*!
+    Sets the directory the images are stored in to \a path.
+*/
+void QPdfDiskCache::setPath(const QString &path)
+{
+    Q_D(QPdfDiskCache);
+
+    if (d->m_path == path)
+        return;
+
+    d->m_path = path;
+    QMetaObject::invokeMethod(d->m_worker, "setPath", Qt::QueuedConnection, Q_ARG(QString, path));
+    emit pathChanged(d->m_path);
+}
+
+/*!
+    \property QPdfDiskCache::maximumSize
+    \brief the number of bytes the stored images may occupy
+
+    When the images exceed this size, the least recently used ones are removed.
+    A size of 0 disables storing images. The default is 256 MiB.
+*/
+
+/*!
+    Returns the number of bytes the stored images may occupy.
+*/
+qint64 QPdfDiskCache::maximumSize() const
+{
+    Q_D(const QPdfDiskCache);
+
+    return d->m_maximumSize;
+}
+
+/*!
+    Sets the number of bytes the stored images may occupy to \a bytes.
+*/
+void QPdfDiskCache::setMaximumSize(qint64 bytes)
+{
+    Q_D(QPdfDiskCache);
+
+    bytes = qMax<qint64>(0, bytes);
+    if (d->m_maximumSize == bytes)
+        return;
+
+    d->m_maximumSize = bytes;
+    QMetaObject::invokeMethod(d->m_worker, "setMaximumSize", Qt::QueuedConnection, Q_ARG(qint64, bytes));
+    emit maximumSizeChanged(d->m_maximumSize);
+}
+
+/*!
+    Returns the fingerprint that identifies the contents of the document, or an empty
+    array if the document is not ready or the fingerprint has not been computed yet.
+
+    The fingerprint is the SHA-1 hash of the whole document, so any change to it
+    results in another fingerprint.
+
+    \sa fingerprintChanged()
+*/
+QByteArray QPdfDiskCache::fingerprint() const
+{
+    Q_D(const QPdfDiskCache);
+
+    return d->m_fingerprint;
+}
+
+/*!
+    Returns whether an image of \a page rendered in \a imageSize with \a options is stored.
+
+    The answer comes from an index that is kept in memory, so this function does not
+    access the disk. The images stored in path() before are only found once the
+    directory has been scanned in the background after the path has been set.
+*/
+bool QPdfDiskCache::contains(int page, QSize imageSize, QPdfDocumentRenderOptions options) const
+{
+    Q_D(const QPdfDiskCache);
+
+    if (d->m_fingerprint.isEmpty())
+        return false;
+
+    return d->m_worker->isStored(d->filePath(page, imageSize, options));
+}
+
+/*!
+    Stores the \a image of \a page that has been rendered in \a imageSize with \a options.
+
+    The image is written in the background. Null images are ignored.
+*/
+void QPdfDiskCache::insert(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options)
+{
+    Q_D(QPdfDiskCache);
+
+    if (!d->m_document || d->m_document->status() != QPdfDocument::Ready || image.isNull() || d->m_maximumSize == 0)
+        return;
+
+    // the worker knows the fingerprint by the time it gets to the image
+    QMetaObject::invokeMethod(d->m_worker, "write", Qt::QueuedConnection,
+                              Q_ARG(int, page), Q_ARG(QSize, imageSize), Q_ARG(QImage, image),
+                              Q_ARG(QPdfDocumentRenderOptions, options));
+}
+
+/*!
+    Requests the image of \a page rendered in \a imageSize with \a options.
+
+    The image is read in the background and delivered through imageLoaded(), with a null
+    image if it could not be read. Returns the ID the image is delivered with, or \c 0 if
+    the image is not stored.
+*/
+quint64 QPdfDiskCache::requestImage(int page, QSize imageSize, QPdfDocumentRenderOptions options)
+{
+    Q_D(QPdfDiskCache);
+
+    if (!contains(page, imageSize, options))
+        return 0;
+
+    const quint64 requestId = d->m_requestIdCounter++;
+
+    QMetaObject::invokeMethod(d->m_worker, "read", Qt::QueuedConnection,
+                              Q_ARG(quint64, requestId), Q_ARG(QString, d->filePath(page, imageSize, options)),
+                              Q_ARG(int, page), Q_ARG(QSize, imageSize), Q_ARG(QPdfDocumentRenderOptions, options));
+
+    return requestId;
+}
+
+/*!
+    Removes the stored images of all documents from path().
+*/
+void QPdfDiskCache::clear()
+{
+    Q_D(QPdfDiskCache);
+
+    QMetaObject::invokeMethod(d->m_worker, "clear", Qt::QueuedConnection);
+}
+
+/*!
+    \fn void QPdfDiskCache::imageLoaded(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId)
+
+    This signal is emitted when the image of \a page requested in \a imageSize with
+    \a options through requestImage() has been read. The \a image is null if it could
+    not be read. The \a requestId is the value requestImage() has returned.
+*/
+
+/*!
+    \fn void QPdfDiskCache::fingerprintChanged(const QByteArray &fingerprint)
+
+    This signal is emitted when the \a fingerprint of the document has been computed,
+    or has been reset because the document has changed. Images stored in an earlier
+    session can be requested once the fingerprint is known.
+
+    \sa fingerprint()
+*/
+
+QT_END_NAMESPACE
+
+#include "qpdfdiskcache.moc"
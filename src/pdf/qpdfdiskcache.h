@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFDISKCACHE_H
+#define QPDFDISKCACHE_H
+
+#include "qtpdfglobal.h"
+
+#include <QImage>
+#include <QObject>
+#include <QPdfDocumentRenderOptions>
+
+QT_BEGIN_NAMESPACE
+
+class QPdfDiskCachePrivate;
+class QPdfDocument;
+
+class Q_PDF_EXPORT QPdfDiskCache : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QPdfDocument* document READ document WRITE setDocument NOTIFY documentChanged)
+    Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+    Q_PROPERTY(qint64 maximumSize READ maximumSize WRITE setMaximumSize NOTIFY maximumSizeChanged)
+
+public:
+    explicit QPdfDiskCache(QObject *parent = nullptr);
+    explicit QPdfDiskCache(QPdfDocument *document, QObject *parent = nullptr);
+    ~QPdfDiskCache();
+
+    QPdfDocument* document() const;
+    void setDocument(QPdfDocument *document);
+
+    QString path() const;
+    void setPath(const QString &path);
+
+    qint64 maximumSize() const;
+    void setMaximumSize(qint64 bytes);
+
+    QByteArray fingerprint() const;
+
+    bool contains(int page, QSize imageSize,
+                  QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions()) const;
+    void insert(int page, QSize imageSize, const QImage &image,
+                QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+    quint64 requestImage(int page, QSize imageSize,
+                         QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+
+    void clear();
+
+Q_SIGNALS:
+    void documentChanged(QPdfDocument *document);
+    void pathChanged(const QString &path);
+    void maximumSizeChanged(qint64 maximumSize);
+    void fingerprintChanged(const QByteArray &fingerprint);
+
+    void imageLoaded(int page, QSize imageSize, const QImage &image,
+                     QPdfDocumentRenderOptions options, quint64 requestId);
+
+private:
+    Q_DECLARE_PRIVATE(QPdfDiskCache)
+};
+
+QT_END_NAMESPACE
+
+#endif
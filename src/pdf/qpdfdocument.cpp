@@ -38,33 +38,65 @@
 #include "qpdfdocument_p.h"
 
 #include "public/fpdf_doc.h"
+#include "public/fpdf_edit.h"
+#include "public/fpdf_progressive.h"
 
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
 #include <QMutex>
 
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
-// The library is not thread-safe at all, it has a lot of global variables.
+// The library keeps some global state (library initialization, last error, and the font
+// mapper with the font and glyph caches that every document uses while its pages are
+// loaded, rendered and closed), which is guarded by this mutex. Everything else is per
+// document and guarded by QPdfDocumentPrivate::mutex, which is always locked first.
 Q_GLOBAL_STATIC_WITH_ARGS(QMutex, pdfMutex, (QMutex::Recursive));
 static int libraryRefCount;
 
+// a page with a few thousand paths or text runs has roughly the memory footprint of
+// a megabyte once parsed, so by default a handful of complex pages stay loaded
+static const int defaultPageCacheLimit = 20000;
+
+// Used while polling the pages in order when the data is fetched with range requests,
+// where only the pages that are actually requested should cause downloads.
+static void ignoreSegment(FX_DOWNLOADHINTS *, size_t, size_t)
+{
+}
+
+static FX_DOWNLOADHINTS noDownloadHints = { 1, ignoreSegment };
+
 QPdfMutexLocker::QPdfMutexLocker()
     : QMutexLocker(pdfMutex())
 {
 }
 
+QPdfMutexLocker::QPdfMutexLocker(const QPdfDocumentPrivate *d)
+    : QMutexLocker(&d->mutex)
+{
+}
+
 QPdfDocumentPrivate::QPdfDocumentPrivate()
-    : avail(nullptr)
+    : mutex(QMutex::Recursive)
+    , avail(nullptr)
     , doc(nullptr)
     , loadComplete(false)
+    , progressiveLoading(false)
+    , mappedData(nullptr)
+    , spoolThreshold(-1)
+    , spoolData(nullptr)
+    , spooledSize(0)
+    , bitmapPool(new QPdfBitmapPool)
     , status(QPdfDocument::Null)
     , lastError(QPdfDocument::NoError)
     , pageCount(0)
+    , firstUnavailablePage(0)
 {
-    asyncBuffer.setData(QByteArray());
-    asyncBuffer.open(QIODevice::ReadWrite);
+    loadedPages.setMaxCost(defaultPageCacheLimit);
 
     const QPdfMutexLocker lock;
 
@@ -89,6 +121,8 @@ QPdfDocumentPrivate::~QPdfDocumentPrivate()
 {
     q->close();
 
+    bitmapPool->deref();
+
     const QPdfMutexLocker lock;
 
     if (!--libraryRefCount)
@@ -100,6 +134,7 @@ QPdfDocumentPrivate::~QPdfDocumentPrivate()
  */
 void QPdfDocument::save(QString path)
 {
+    const QPdfMutexLocker lock(d.data());
 
     Writer writer(path);
     writer.saveAs(d->doc);
@@ -107,43 +142,91 @@ void QPdfDocument::save(QString path)
 
 void QPdfDocumentPrivate::clear()
 {
-    QPdfMutexLocker lock;
+    QPdfMutexLocker lock(this);
+    QPdfMutexLocker globalLock;
+
+    loadedPages.clear();
 
     if (doc)
         FPDF_CloseDocument(doc);
     doc = nullptr;
+    globalLock.unlock();
 
     if (avail)
         FPDFAvail_Destroy(avail);
     avail = nullptr;
+
+    // the page sizes are read by render threads as well
+    pageSizes.clear();
+    pageAvailability.clear();
     lock.unlock();
 
+    firstUnavailablePage = 0;
+    requestedPages.clear();
+
     if (pageCount != 0) {
         pageCount = 0;
         emit q->pageCountChanged(pageCount);
     }
 
     loadComplete = false;
+    fileName.clear();
+    mappedData = nullptr;
+    blockCache.setDevice(nullptr, 0);
+    ownDevice.reset(); // unmaps the file of mappedData
+    rangeLoader.reset();
+
+    asyncBuffer.clear();
 
-    asyncBuffer.close();
-    asyncBuffer.setData(QByteArray());
-    asyncBuffer.open(QIODevice::ReadWrite);
+    if (spoolFile) {
+        spoolFile->unmap(spoolData);
+        spoolFile.reset();
+    }
+    spoolData = nullptr;
+    spooledSize = 0;
 
     if (sequentialSourceDevice)
         sequentialSourceDevice->disconnect(q);
 }
 
-void QPdfDocumentPrivate::updateLastError()
+QPdfPageHandle::QPdfPageHandle(QPdfDocumentPrivate *d, int index)
+    : m_globalLock()
+    , m_page(nullptr)
+    , m_owned(false)
+{
+    if (QPdfLoadedPage *loadedPage = d->loadedPages.object(index)) {
+        m_page = loadedPage->page;
+        return;
+    }
+
+    m_page = FPDF_LoadPage(d->doc, index);
+    if (!m_page)
+        return;
+
+    if (d->loadedPages.maxCost() <= 0) {
+        m_owned = true;
+        return;
+    }
+
+    // a page that is more expensive than the whole cache still replaces everything else,
+    // since it is the one that is currently needed
+    const int cost = qMin(1 + FPDFPage_CountObject(m_page), d->loadedPages.maxCost());
+    d->loadedPages.insert(index, new QPdfLoadedPage(m_page), cost);
+}
+
+QPdfPageHandle::~QPdfPageHandle()
+{
+    if (m_owned)
+        FPDF_ClosePage(m_page);
+}
+
+void QPdfDocumentPrivate::updateLastError(unsigned long error)
 {
     if (doc) {
         lastError = QPdfDocument::NoError;
         return;
     }
 
-    QPdfMutexLocker lock;
-    const unsigned long error = FPDF_GetLastError();
-    lock.unlock();
-
     switch (error) {
     case FPDF_ERR_SUCCESS: lastError = QPdfDocument::NoError; break;
     case FPDF_ERR_UNKNOWN: lastError = QPdfDocument::UnknownError; break;
@@ -165,7 +248,7 @@ void QPdfDocumentPrivate::load(QIODevice *newDevice, bool transferDeviceOwnershi
 
     if (newDevice->isSequential()) {
         sequentialSourceDevice = newDevice;
-        device = &asyncBuffer;
+        device = nullptr;
         QNetworkReply *reply = qobject_cast<QNetworkReply*>(sequentialSourceDevice);
 
         if (!reply) {
@@ -201,7 +284,7 @@ void QPdfDocumentPrivate::_q_tryLoadingWithSizeFromContentHeader()
     if (avail)
         return;
 
-    const QNetworkReply *networkReply = qobject_cast<QNetworkReply*>(sequentialSourceDevice);
+    QNetworkReply *networkReply = qobject_cast<QNetworkReply*>(sequentialSourceDevice);
     if (!networkReply) {
         setStatus(QPdfDocument::Error);
         return;
@@ -213,6 +296,27 @@ void QPdfDocumentPrivate::_q_tryLoadingWithSizeFromContentHeader()
         return;
     }
 
+    // When the server can serve byte ranges, fetch only the segments PDFium asks for
+    // instead of downloading the whole document from start to end.
+    if (progressiveLoading && QPdfRangeLoader::supportsRangeRequests(networkReply)) {
+        rangeLoader.reset(new QPdfRangeLoader(networkReply->manager(), networkReply->request(), contentLength.toLongLong()));
+        QObject::connect(rangeLoader.data(), &QPdfRangeLoader::dataArrived, q, [this]() { checkComplete(); });
+        // the loader has already retried, without the data the pages waiting for it never arrive
+        QObject::connect(rangeLoader.data(), &QPdfRangeLoader::errorOccurred, q, [this]() {
+            setStatus(QPdfDocument::Error);
+        });
+
+        networkReply->disconnect(q);
+        networkReply->abort();
+
+        initiateAsyncLoadWithTotalSizeKnown(contentLength.toULongLong());
+        checkComplete();
+        return;
+    }
+
+    if (spoolThreshold >= 0 && contentLength.toLongLong() >= spoolThreshold)
+        openSpoolFile(contentLength.toLongLong());
+
     QObject::connect(sequentialSourceDevice, SIGNAL(readyRead()), q, SLOT(_q_copyFromSequentialSourceDevice()));
 
     initiateAsyncLoadWithTotalSizeKnown(contentLength.toULongLong());
@@ -226,43 +330,120 @@ void QPdfDocumentPrivate::initiateAsyncLoadWithTotalSizeKnown(quint64 totalSize)
     // FPDF_FILEACCESS setup
     m_FileLen = totalSize;
 
-    const QPdfMutexLocker lock;
+    if (device && !mappedData)
+        blockCache.setDevice(device, totalSize);
+
+    const QPdfMutexLocker lock(this);
 
     avail = FPDFAvail_Create(this, this);
 }
 
+bool QPdfDocumentPrivate::openSpoolFile(qint64 totalSize)
+{
+    QScopedPointer<QTemporaryFile> file(new QTemporaryFile);
+
+    // resizing does not allocate disk space on file systems with sparse files
+    if (!file->open() || !file->resize(totalSize)) {
+        qWarning() << "QPdfDocument: Cannot create a spool file, keeping the document in memory.";
+        return false;
+    }
+
+    uchar *data = totalSize > 0 ? file->map(0, totalSize) : nullptr;
+    if (!data) {
+        qWarning() << "QPdfDocument: Cannot map the spool file, keeping the document in memory.";
+        return false;
+    }
+
+    spoolFile.swap(file);
+    spoolData = data;
+    spooledSize = 0;
+
+    return true;
+}
+
+qint64 QPdfDocumentPrivate::receivedSize() const
+{
+    if (device)
+        return device->size();
+
+    if (spoolData)
+        return spooledSize;
+
+    return asyncBuffer.size();
+}
+
+// Returns a copy of the whole document, or an empty array if it is not loaded or not all
+// of its data has been received, as with documents fetched with range requests.
+QByteArray QPdfDocumentPrivate::readContent()
+{
+    const QPdfMutexLocker lock(this);
+
+    if (!doc || m_FileLen == 0 || m_FileLen > quint64(std::numeric_limits<int>::max()))
+        return QByteArray();
+
+    QByteArray content(int(m_FileLen), Qt::Uninitialized);
+    if (fpdf_GetBlock(static_cast<FPDF_FILEACCESS*>(this), 0, reinterpret_cast<uchar *>(content.data()), m_FileLen) != int(m_FileLen))
+        return QByteArray();
+
+    return content;
+}
+
 void QPdfDocumentPrivate::_q_copyFromSequentialSourceDevice()
 {
     if (loadComplete)
         return;
 
+    if (spoolData) {
+        // read straight into the mapping, the pages are written back to the spool
+        // file by the system and can be dropped from memory when needed
+        const qint64 bytesRead = sequentialSourceDevice->read(reinterpret_cast<char *>(spoolData + spooledSize),
+                                                              qMin(sequentialSourceDevice->bytesAvailable(), qint64(m_FileLen) - spooledSize));
+        if (bytesRead <= 0)
+            return;
+
+        QPdfMutexLocker lock(this);
+        spooledSize += bytesRead;
+        lock.unlock();
+
+        checkComplete();
+        return;
+    }
+
     const QByteArray data = sequentialSourceDevice->read(sequentialSourceDevice->bytesAvailable());
     if (data.isEmpty())
         return;
 
-    asyncBuffer.seek(asyncBuffer.size());
-    asyncBuffer.write(data);
+    asyncBuffer.append(data);
 
     checkComplete();
 }
 
 void QPdfDocumentPrivate::tryLoadDocument()
 {
-    QPdfMutexLocker lock;
+    QPdfMutexLocker lock(this);
 
     if (!FPDFAvail_IsDocAvail(avail, this))
         return;
 
     Q_ASSERT(!doc);
 
+    // FPDF_GetLastError() is shared by all documents, so it has to be read
+    // under the global lock together with the call that sets it
+    QPdfMutexLocker globalLock;
     doc = FPDFAvail_GetDocument(avail, password);
+    const unsigned long error = FPDF_GetLastError();
+    globalLock.unlock();
     lock.unlock();
 
-    updateLastError();
+    updateLastError(error);
 
     if (lastError == QPdfDocument::IncorrectPasswordError) {
+        lock.relock();
+        globalLock.relock();
         FPDF_CloseDocument(doc);
         doc = nullptr;
+        globalLock.unlock();
+        lock.unlock();
 
         setStatus(QPdfDocument::Error);
         emit q->passwordRequired();
@@ -280,31 +461,109 @@ void QPdfDocumentPrivate::checkComplete()
     if (!doc)
         return;
 
-    loadComplete = true;
+    QPdfMutexLocker lock(this);
 
-    QPdfMutexLocker lock;
+    const int firstPage = qMax(0, FPDFAvail_GetFirstPageNum(doc));
 
-    const int newPageCount = FPDF_GetPageCount(doc);
-    for (int i = 0; i < newPageCount; ++i) {
-        int result = PDF_DATA_NOTAVAIL;
-        while (result == PDF_DATA_NOTAVAIL) {
-            result = FPDFAvail_IsPageAvail(avail, i, this);
-        }
+    if (pageSizes.isEmpty()) {
+        const int newPageCount = FPDF_GetPageCount(doc);
+        pageSizes.resize(newPageCount);
+        pageAvailability.resize(newPageCount);
 
-        if (result == PDF_DATA_ERROR)
-            loadComplete = false;
+        if (rangeLoader && firstPage < newPageCount)
+            requestedPages.insert(firstPage);
     }
 
+    const int newPageCount = pageSizes.size();
+
+    QVector<int> newlyAvailablePages;
+
+    // pages somebody asked for are allowed to request their data from the server
+    for (auto it = requestedPages.begin(); it != requestedPages.end(); ) {
+        if (updatePageAvailability(*it, &newlyAvailablePages, this))
+            it = requestedPages.erase(it);
+        else
+            ++it;
+    }
+
+    // Pages of linearized documents arrive in order, so only look at the pages up
+    // to the first one that is still missing instead of polling all of them.
+    FX_DOWNLOADHINTS *hints = rangeLoader ? &noDownloadHints : this;
+    while (firstUnavailablePage < newPageCount && updatePageAvailability(firstUnavailablePage, &newlyAvailablePages, hints))
+        ++firstUnavailablePage;
+
+    loadComplete = (firstUnavailablePage == newPageCount);
+
+    // in progressive mode the document can be used as soon as its first page is there
+    const bool usable = loadComplete || (progressiveLoading && firstPage < newPageCount && pageAvailability.testBit(firstPage));
+
     lock.unlock();
 
-    if (loadComplete) {
-        if (newPageCount != pageCount) {
-            pageCount = newPageCount;
-            emit q->pageCountChanged(pageCount);
-        }
+    if (!usable)
+        return;
 
-        setStatus(QPdfDocument::Ready);
+    if (status == QPdfDocument::Ready) {
+        for (int page : qAsConst(newlyAvailablePages))
+            emit q->pageAvailable(page);
+        return;
     }
+
+    if (newPageCount != pageCount) {
+        pageCount = newPageCount;
+        emit q->pageCountChanged(pageCount);
+    }
+
+    setStatus(QPdfDocument::Ready);
+}
+
+void QPdfDocumentPrivate::_q_checkComplete()
+{
+    checkComplete();
+}
+
+bool QPdfDocumentPrivate::updatePageAvailability(int page, QVector<int> *newlyAvailablePages, FX_DOWNLOADHINTS *hints)
+{
+    if (pageAvailability.testBit(page))
+        return true;
+
+    // once all data is there, PDFium only needs to be polled until it has parsed what it needs
+    const bool allDataAvailable = !rangeLoader && receivedSize() >= qint64(m_FileLen);
+
+    int result = PDF_DATA_NOTAVAIL;
+    do {
+        result = FPDFAvail_IsPageAvail(avail, page, hints);
+    } while (result == PDF_DATA_NOTAVAIL && allDataAvailable);
+
+    if (result != PDF_DATA_AVAIL)
+        return false;
+
+    // the page sizes are queried a lot (e.g. for every layout of a view), so look them up only once
+    double width = 0;
+    double height = 0;
+    FPDF_GetPageSizeByIndex(doc, page, &width, &height);
+    pageSizes[page] = QSizeF(width, height);
+
+    pageAvailability.setBit(page);
+    newlyAvailablePages->append(page);
+
+    return true;
+}
+
+bool QPdfDocumentPrivate::isPageAvailable(int page) const
+{
+    return page >= 0 && page < pageAvailability.size() && pageAvailability.testBit(page);
+}
+
+// The caller holds the document lock, the check runs in the document's thread.
+void QPdfDocumentPrivate::requestPage(int page)
+{
+    // with range requests nothing is downloaded unless somebody asks for it
+    if (!rangeLoader || isPageAvailable(page) || page < 0 || page >= pageAvailability.size()
+            || requestedPages.contains(page))
+        return;
+
+    requestedPages.insert(page);
+    QMetaObject::invokeMethod(q, "_q_checkComplete", Qt::QueuedConnection);
 }
 
 void QPdfDocumentPrivate::setStatus(QPdfDocument::Status documentStatus)
@@ -319,22 +578,48 @@ void QPdfDocumentPrivate::setStatus(QPdfDocument::Status documentStatus)
 FPDF_BOOL QPdfDocumentPrivate::fpdf_IsDataAvail(_FX_FILEAVAIL *pThis, size_t offset, size_t size)
 {
     QPdfDocumentPrivate *d = static_cast<QPdfDocumentPrivate*>(pThis);
-    return offset + size <= static_cast<quint64>(d->device->size());
+
+    if (d->rangeLoader)
+        return d->rangeLoader->isAvailable(offset, size);
+
+    return offset + size <= static_cast<quint64>(d->receivedSize());
 }
 
 int QPdfDocumentPrivate::fpdf_GetBlock(void *param, unsigned long position, unsigned char *pBuf, unsigned long size)
 {
     QPdfDocumentPrivate *d = static_cast<QPdfDocumentPrivate*>(reinterpret_cast<FPDF_FILEACCESS*>(param));
-    d->device->seek(position);
-    return qMax(qint64(0), d->device->read(reinterpret_cast<char *>(pBuf), size));
 
+    if (d->mappedData) {
+        if (quint64(position) + size > d->m_FileLen)
+            return 0;
+
+        memcpy(pBuf, d->mappedData + position, size);
+        return size;
+    }
+
+    if (d->rangeLoader)
+        return d->rangeLoader->read(position, reinterpret_cast<char *>(pBuf), size);
+
+    if (d->spoolData) {
+        if (qint64(position) + size > d->spooledSize)
+            return 0;
+
+        memcpy(pBuf, d->spoolData + position, size);
+        return size;
+    }
+
+    if (!d->device)
+        return d->asyncBuffer.read(position, reinterpret_cast<char *>(pBuf), size);
+
+    return d->blockCache.read(position, reinterpret_cast<char *>(pBuf), size);
 }
 
 void QPdfDocumentPrivate::fpdf_AddSegment(_FX_DOWNLOADHINTS *pThis, size_t offset, size_t size)
 {
-    Q_UNUSED(pThis);
-    Q_UNUSED(offset);
-    Q_UNUSED(size);
+    QPdfDocumentPrivate *d = static_cast<QPdfDocumentPrivate*>(pThis);
+
+    if (d->rangeLoader)
+        d->rangeLoader->requestRange(offset, size);
 }
 
 /*!
@@ -343,6 +628,10 @@ void QPdfDocumentPrivate::fpdf_AddSegment(_FX_DOWNLOADHINTS *pThis, size_t offse
     \inmodule QtPdf
 
     \brief The QPdfDocument class loads a PDF document and renders pages from it.
+
+    Access to a single document is serialized internally, while different
+    QPdfDocument instances can render pages from different threads at the
+    same time.
 */
 
 /*!
@@ -368,11 +657,19 @@ QPdfDocument::DocumentError QPdfDocument::load(const QString &fileName)
 
     d->setStatus(QPdfDocument::Loading);
 
+    d->fileName.clear();
+
     QScopedPointer<QFile> f(new QFile(fileName));
     if (!f->open(QIODevice::ReadOnly)) {
         d->lastError = FileNotFoundError;
         d->setStatus(QPdfDocument::Error);
     } else {
+        d->fileName = fileName;
+
+        // Serve PDFium's block reads straight from the page cache. If the file cannot
+        // be mapped (e.g. not enough address space) it is read through the QFile instead.
+        d->mappedData = f->size() > 0 ? f->map(0, f->size()) : nullptr;
+
         d->load(f.take(), /*transfer ownership*/true);
     }
     return d->lastError;
@@ -407,6 +704,7 @@ void QPdfDocument::load(QIODevice *device)
 
     d->setStatus(QPdfDocument::Loading);
 
+    d->fileName.clear();
     d->load(device, /*transfer ownership*/false);
 }
 
@@ -482,7 +780,7 @@ QVariant QPdfDocument::metaData(MetaDataField field) const
         break;
     }
 
-    QPdfMutexLocker lock;
+    QPdfMutexLocker lock(d.data());
     const unsigned long len = FPDF_GetMetaText(d->doc, fieldName.constData(), nullptr, 0);
 
     QVector<ushort> buf(len);
@@ -529,8 +827,12 @@ QPdfDocument::DocumentError QPdfDocument::error() const
 */
 void QPdfDocument::close()
 {
-    if (!d->doc)
+    // a load that failed or has not finished yet leaves no document behind, but the
+    // data source it set up must not be used by the next load()
+    if (!d->doc) {
+        d->clear();
         return;
+    }
 
     d->setStatus(Unloading);
 
@@ -553,45 +855,130 @@ int QPdfDocument::pageCount() const
     return d->pageCount;
 }
 
+/*!
+    Returns the size of \a page in points (1/72 of an inch), or an invalid
+    size if no document is loaded, the page does not exist or it is not
+    available yet.
+
+    \sa pageSizes()
+*/
 QSizeF QPdfDocument::pageSize(int page) const
 {
-    QSizeF result;
-    if (!d->doc)
-        return result;
+    // the sizes are filled in while the document is loading progressively
+    const QPdfMutexLocker lock(d.data());
 
-    const QPdfMutexLocker lock;
+    if (page < 0 || page >= d->pageSizes.size())
+        return QSizeF();
 
-    FPDF_GetPageSizeByIndex(d->doc, page, &result.rwidth(), &result.rheight());
-    return result;
+    return d->pageSizes.at(page);
 }
 
 /*!
-    Renders the \a page into a QImage of size \a imageSize according to the
-    provided \a renderOptions.
+    \since 5.11
 
-    Returns the rendered page or an empty image in case of an error.
+    Returns the sizes of all pages in points (1/72 of an inch), indexed by page
+    number. The sizes are determined once when a page becomes available, so
+    this is much cheaper than calling pageSize() for every page. The entries
+    of pages that are not available yet are invalid sizes.
 
-    Note: If the \a imageSize does not match the aspect ratio of the page in the
-    PDF document, the page is rendered scaled, so that it covers the
-    complete \a imageSize.
+    \sa pageSize()
 */
-QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions renderOptions)
+QVector<QSizeF> QPdfDocument::pageSizes() const
 {
-    if (!d->doc)
-        return QImage();
+    const QPdfMutexLocker lock(d.data());
 
-    const QPdfMutexLocker lock;
+    return d->pageSizes;
+}
+
+// Asks PDFium to pause a progressive rendering once it has been cancelled or ran out of time
+struct QPdfRenderPause : public IFSDK_PAUSE
+{
+    QPdfRenderPause(QDeadlineTimer deadline, const QAtomicInt *cancelled)
+        : deadline(deadline)
+        , cancelled(cancelled)
+    {
+        version = 1;
+        NeedToPauseNow = needToPauseNow;
+        user = nullptr;
+    }
+
+    bool isCancelled() const { return cancelled && cancelled->load(); }
+    bool shouldStop() const { return isCancelled() || deadline.hasExpired(); }
 
-    FPDF_PAGE pdfPage = FPDF_LoadPage(d->doc, page);
+    static FPDF_BOOL needToPauseNow(IFSDK_PAUSE *pause)
+    {
+        return static_cast<QPdfRenderPause*>(pause)->shouldStop();
+    }
+
+    QDeadlineTimer deadline;
+    const QAtomicInt *cancelled;
+};
+
+QRect QPdfDocumentPrivate::renderRect(QSize imageSize, QPdfDocumentRenderOptions options)
+{
+    const QRect pageRect(QPoint(0, 0), imageSize);
+
+    return options.tileSize() > 0 ? options.tileRect() & pageRect : pageRect;
+}
+
+bool QPdfDocumentPrivate::renderPage(int page, uchar *buffer, int bytesPerLine, QImage::Format format,
+                                     QSize imageSize, const QRect &region, QPdfDocumentRenderOptions options,
+                                     QDeadlineTimer deadline, const QAtomicInt *cancelled, bool *complete)
+{
+    if (complete)
+        *complete = false;
+
+    if (!doc || !buffer || region.isEmpty())
+        return false;
+
+    int bitmapFormat = 0;
+    FPDF_DWORD background = 0;
+    int formatFlags = 0;
+    switch (format) {
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        bitmapFormat = FPDFBitmap_BGRA;
+        background = 0x00000000;
+        break;
+    case QImage::Format_RGB32:
+        bitmapFormat = FPDFBitmap_BGRx;
+        background = 0xFFFFFFFF;
+        break;
+    case QImage::Format_Grayscale8:
+        bitmapFormat = FPDFBitmap_Gray;
+        background = 0xFFFFFFFF;
+        break;
+    case QImage::Format_RGB888:
+        // QImage stores the bytes in RGB order, PDFium in BGR order unless told otherwise
+        bitmapFormat = FPDFBitmap_BGR;
+        background = 0xFFFFFFFF;
+        formatFlags = FPDF_REVERSE_BYTE_ORDER;
+        break;
+    default:
+        qWarning() << "QPdfDocument: Unsupported image format" << format;
+        return false;
+    }
+
+    const QPdfMutexLocker lock(this);
+
+    if (!isPageAvailable(page)) {
+        requestPage(page);
+        return false;
+    }
+
+    const QPdfPageHandle pageHandle(this, page);
+    FPDF_PAGE pdfPage = pageHandle.page();
     if (!pdfPage)
-        return QImage();
+        return false;
+
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(region.width(), region.height(), bitmapFormat, buffer, bytesPerLine);
+    if (!bitmap)
+        return false;
 
-    QImage result(imageSize, QImage::Format_ARGB32);
-    result.fill(Qt::transparent);
-    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(result.width(), result.height(), FPDFBitmap_BGRA, result.bits(), result.bytesPerLine());
+    FPDFBitmap_FillRect(bitmap, 0, 0, region.width(), region.height(), background);
 
     int rotation = 0;
-    switch (renderOptions.rotation()) {
+    switch (options.rotation()) {
     case QPdf::Rotate0:
         rotation = 0;
         break;
@@ -606,8 +993,8 @@ QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions
         break;
     }
 
-    const QPdf::RenderFlags renderFlags = renderOptions.renderFlags();
-    int flags = 0;
+    const QPdf::RenderFlags renderFlags = options.renderFlags();
+    int flags = formatFlags;
     if (renderFlags & QPdf::RenderAnnotations)
         flags |= FPDF_ANNOT;
     if (renderFlags & QPdf::RenderOptimizedForLcd)
@@ -623,15 +1010,426 @@ QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions
     if (renderFlags & QPdf::RenderPathAliased)
         flags |= FPDF_RENDER_NO_SMOOTHPATH;
 
-    FPDF_RenderPageBitmap(bitmap, pdfPage, 0, 0, result.width(), result.height(), rotation, flags);
+    // The page is placed so that the region ends up at the origin of the bitmap;
+    // PDFium clips everything outside of the bitmap before rasterizing it.
+    bool finished = true;
+    if (deadline.isForever() && !cancelled) {
+        FPDF_RenderPageBitmap(bitmap, pdfPage, -region.x(), -region.y(), imageSize.width(), imageSize.height(), rotation, flags);
+    } else {
+        // the progressive renderer returns to us whenever the pause callback asks for it,
+        // which only happens once the request has been cancelled or its time is up
+        QPdfRenderPause pause(deadline, cancelled);
+
+        int state = FPDF_RenderPageBitmap_Start(bitmap, pdfPage, -region.x(), -region.y(),
+                                                imageSize.width(), imageSize.height(), rotation, flags, &pause);
+        while (state == FPDF_RENDER_TOBECOUNTINUED && !pause.shouldStop())
+            state = FPDF_RenderPage_Continue(pdfPage, &pause);
+
+        FPDF_RenderPage_Close(pdfPage);
+
+        if (pause.isCancelled()) {
+            FPDFBitmap_Destroy(bitmap);
+            return false;
+        }
+
+        finished = (state == FPDF_RENDER_DONE);
+    }
 
     FPDFBitmap_Destroy(bitmap);
 
-    FPDF_ClosePage(pdfPage);
+    // PDFium only produces unpremultiplied alpha, fully opaque pixels can stay as they are
+    if (format == QImage::Format_ARGB32_Premultiplied) {
+        for (int y = 0; y < region.height(); ++y) {
+            QRgb *line = reinterpret_cast<QRgb*>(buffer + y * bytesPerLine);
+            for (int x = 0; x < region.width(); ++x) {
+                if (qAlpha(line[x]) != 255)
+                    line[x] = qPremultiply(line[x]);
+            }
+        }
+    }
+
+    if (complete)
+        *complete = finished;
+
+    return true;
+}
+
+/*!
+    Renders the \a page into a QImage of size \a imageSize according to the
+    provided \a renderOptions.
+
+    Returns the rendered page or an empty image in case of an error.
+
+    Note: If the \a imageSize does not match the aspect ratio of the page in the
+    PDF document, the page is rendered scaled, so that it covers the
+    complete \a imageSize.
+
+    If \a renderOptions describe a tile, only that tile of the page image is
+    rendered, and the returned image has the size of the tile. The image has the
+    format set with QPdfDocumentRenderOptions::setImageFormat().
+
+    \sa QPdfDocumentRenderOptions::setTile(), renderRegion()
+*/
+QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions renderOptions)
+{
+    return render(page, imageSize, renderOptions, QDeadlineTimer(QDeadlineTimer::Forever));
+}
+
+/*!
+    \since 5.11
+
+    Renders the \a page into a QImage of size \a imageSize according to the
+    provided \a renderOptions, and stops early if the rendering takes too long
+    or is no longer needed.
+
+    The rendering is done in steps. Between the steps, it is checked whether
+    \a deadline has expired or \a cancelled (if not \c nullptr) has been set to a
+    non-zero value from another thread.
+
+    \list
+    \li If \a deadline expires, the page rendered so far is returned, which may
+        lack some of the page's content.
+    \li If the rendering is cancelled, an empty image is returned.
+    \endlist
+
+    If \a complete is not \c nullptr, it is set to whether the whole page has
+    been rendered.
+
+    Since a document renders only one page at a time, a cancellation also lets
+    other requests for the same document proceed sooner.
+
+    \sa render()
+*/
+QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions renderOptions,
+                            QDeadlineTimer deadline, const QAtomicInt *cancelled, bool *complete)
+{
+    if (complete)
+        *complete = false;
+
+    if (!d->doc)
+        return QImage();
+
+    const QPdfMutexLocker lock(d.data());
+
+    if (!d->isPageAvailable(page)) {
+        d->requestPage(page);
+        return QImage();
+    }
+
+    const QRect region = QPdfDocumentPrivate::renderRect(imageSize, renderOptions);
+
+    QImage result = d->bitmapPool->acquire(region.size(), renderOptions.imageFormat());
+    if (!d->renderPage(page, result.bits(), result.bytesPerLine(), result.format(), imageSize, region, renderOptions,
+                       deadline, cancelled, complete))
+        return QImage();
+
+    return result;
+}
+
+/*!
+    \since 5.11
+
+    Renders the \a page into \a image according to the provided \a renderOptions,
+    scaled to cover the size of \a image.
+
+    Unlike the overload returning a QImage, this does not allocate any pixel data,
+    so an image can be reused for rendering many times. The format of \a image must
+    be one of those supported by QPdfDocumentRenderOptions::setImageFormat(); the
+    image format of \a renderOptions is ignored. The tile of \a renderOptions is
+    ignored as well; use the overload taking a buffer to render tiles without
+    allocations.
+
+    Returns \c true if the page has been rendered.
+*/
+bool QPdfDocument::render(int page, QImage *image, QPdfDocumentRenderOptions renderOptions)
+{
+    if (!image || image->isNull())
+        return false;
+
+    const QRect region(QPoint(0, 0), image->size());
+    return d->renderPage(page, image->bits(), image->bytesPerLine(), image->format(), image->size(), region, renderOptions);
+}
+
+/*!
+    \since 5.11
+
+    Renders the \a page into the pixel \a buffer according to the provided
+    \a renderOptions, scaled to cover \a imageSize.
+
+    The buffer holds \a imageSize.height() scan lines that are \a bytesPerLine bytes
+    apart, in the given \a format, which must be one of those supported by
+    QPdfDocumentRenderOptions::setImageFormat(). If \a renderOptions describe a tile, the buffer only holds
+    the tile, that is QPdfDocumentRenderOptions::tileRect() clipped to \a imageSize.
+    The buffer is cleared before rendering.
+
+    Returns \c true if the page has been rendered.
+*/
+bool QPdfDocument::render(int page, uchar *buffer, QSize imageSize, int bytesPerLine, QImage::Format format,
+                          QPdfDocumentRenderOptions renderOptions)
+{
+    const QRect region = QPdfDocumentPrivate::renderRect(imageSize, renderOptions);
+
+    return d->renderPage(page, buffer, bytesPerLine, format, imageSize, region, renderOptions);
+}
+
+/*!
+    \since 5.11
+
+    Renders the part \a clip of the \a page at the given \a scale according to the
+    provided \a renderOptions.
+
+    At a \a scale of \c 1.0, one pixel corresponds to one point (1/72 of an inch)
+    of the page, and \a clip is given in the pixels of the whole page image at
+    \a scale, after applying the rotation of \a renderOptions. The returned image
+    has the size of \a clip clipped to the page image, so the memory needed does not
+    depend on the zoom level. The tile of \a renderOptions is ignored.
+
+    Returns the rendered region or an empty image in case of an error.
+
+    \sa render(), pageSize()
+*/
+QImage QPdfDocument::renderRegion(int page, qreal scale, const QRect &clip, QPdfDocumentRenderOptions renderOptions)
+{
+    if (!d->doc || scale <= 0)
+        return QImage();
+
+    const QPdfMutexLocker lock(d.data());
+
+    if (!d->isPageAvailable(page)) {
+        d->requestPage(page);
+        return QImage();
+    }
+
+    QSizeF pageSize = d->pageSizes.at(page) * scale;
+    if (renderOptions.rotation() == QPdf::Rotate90 || renderOptions.rotation() == QPdf::Rotate270)
+        pageSize.transpose();
+
+    const QSize imageSize = pageSize.toSize();
+    const QRect region = clip & QRect(QPoint(0, 0), imageSize);
+
+    QImage result = d->bitmapPool->acquire(region.size(), renderOptions.imageFormat());
+    if (!d->renderPage(page, result.bits(), result.bytesPerLine(), result.format(), imageSize, region, renderOptions))
+        return QImage();
 
     return result;
 }
 
+/*!
+    \since 5.11
+
+    Returns the number of bytes of pixel data that are kept for reuse by render().
+
+    \sa setBitmapPoolLimit()
+*/
+qint64 QPdfDocument::bitmapPoolLimit() const
+{
+    return d->bitmapPool->limit();
+}
+
+/*!
+    \since 5.11
+
+    Sets the number of \a bytes of pixel data that are kept for reuse by render().
+
+    When the limit is larger than \c 0, the buffers of the images returned by
+    render() are recycled once the images are destroyed, and later calls with the
+    same image size reuse them instead of allocating new ones. This avoids the
+    allocation of a large image for every frame while, for example, scrolling
+    through a document at a high zoom level. The default limit is \c 0, which
+    disables the reuse.
+
+    \sa bitmapPoolLimit()
+*/
+void QPdfDocument::setBitmapPoolLimit(qint64 bytes)
+{
+    d->bitmapPool->setLimit(bytes);
+}
+
+/*!
+    \since 5.11
+
+    Returns whether progressive loading is enabled.
+
+    \sa setProgressiveLoading()
+*/
+bool QPdfDocument::progressiveLoading() const
+{
+    return d->progressiveLoading;
+}
+
+/*!
+    \since 5.11
+
+    Sets whether the document is loaded progressively to \a enabled.
+
+    By default, a document loaded from a QNetworkReply only changes its status to
+    Ready once all of its pages are available. With progressive loading, the
+    document becomes Ready as soon as its first page is available, which for
+    linearized ("fast web view") documents does not depend on the size of the
+    file. The other pages can be queried with isPageAvailable(), and
+    pageAvailable() is emitted when they arrive.
+
+    If the server of a QNetworkReply announces support for byte ranges
+    (\c{Accept-Ranges: bytes}), the reply is aborted and the document fetches only
+    the parts it needs with HTTP range requests: the document structure, the first
+    page, and the pages passed to requestPage() or rendered.
+
+    The setting takes effect on the next call to load().
+
+    \sa isPageAvailable(), requestPage(), pageAvailable()
+*/
+void QPdfDocument::setProgressiveLoading(bool enabled)
+{
+    d->progressiveLoading = enabled;
+}
+
+/*!
+    \since 5.11
+
+    Returns whether the data of \a page has been loaded, so that it can be rendered.
+
+    \sa requestPage(), progressiveLoading(), pageAvailable()
+*/
+bool QPdfDocument::isPageAvailable(int page) const
+{
+    const QPdfMutexLocker lock(d.data());
+
+    return d->isPageAvailable(page);
+}
+
+/*!
+    \since 5.11
+
+    Starts fetching the data of \a page if the document is loaded with HTTP range
+    requests and the page is not available yet. pageAvailable() is emitted once the
+    data has arrived. Rendering a page that is not available requests it as well.
+
+    Does nothing for documents that are loaded in another way, since their data
+    arrives from start to end anyway.
+
+    \sa isPageAvailable(), progressiveLoading()
+*/
+void QPdfDocument::requestPage(int page)
+{
+    const QPdfMutexLocker lock(d.data());
+
+    d->requestPage(page);
+}
+
+/*!
+    \fn void QPdfDocument::pageAvailable(int page)
+    \since 5.11
+
+    This signal is emitted when the data of \a page has been loaded after
+    the document has already become Ready. This only happens when
+    progressiveLoading() is enabled.
+
+    \sa isPageAvailable()
+*/
+
+/*!
+    \since 5.11
+
+    Returns the size from which documents loaded from a QNetworkReply are
+    spooled to disk, or \c -1 if spooling is disabled.
+
+    \sa setSpoolThreshold()
+*/
+qint64 QPdfDocument::spoolThreshold() const
+{
+    return d->spoolThreshold;
+}
+
+/*!
+    \since 5.11
+
+    Sets the size from which documents loaded from a QNetworkReply are
+    spooled to disk to \a bytes.
+
+    By default, a document loaded from a QNetworkReply is kept in memory. When its
+    announced size (the \c Content-Length header) is at least \a bytes, the data
+    is written to a temporary file instead and read back through a memory mapping,
+    so memory usage does not grow with the size of the document. A value of \c -1,
+    the default, disables spooling.
+
+    The setting takes effect on the next call to load().
+
+    \sa spoolThreshold()
+*/
+void QPdfDocument::setSpoolThreshold(qint64 bytes)
+{
+    d->spoolThreshold = qMax(qint64(-1), bytes);
+}
+
+/*!
+    \since 5.11
+
+    Returns the limit for the pages that are kept parsed in memory.
+
+    \sa setPageCacheLimit()
+*/
+int QPdfDocument::pageCacheLimit() const
+{
+    const QPdfMutexLocker lock(d.data());
+
+    return d->loadedPages.maxCost();
+}
+
+/*!
+    \since 5.11
+
+    Sets the \a limit for the pages that are kept parsed in memory.
+
+    Parsing the content stream of a page is often more expensive than rasterizing it,
+    so pages that have been rendered once stay parsed and are reused by subsequent
+    calls to render() with different sizes or options. When the limit is exceeded,
+    the least recently used pages are released.
+
+    The limit is expressed as the total number of page objects (text runs, paths and
+    images) of the cached pages, which approximates their memory footprint. A page
+    that alone exceeds the limit replaces all other cached pages. A limit of \c 0
+    disables caching.
+
+    \sa pageCacheLimit(), releasePage(), releaseAllPages()
+*/
+void QPdfDocument::setPageCacheLimit(int limit)
+{
+    const QPdfMutexLocker lock(d.data());
+    const QPdfMutexLocker globalLock;
+
+    d->loadedPages.setMaxCost(qMax(0, limit));
+}
+
+/*!
+    \since 5.11
+
+    Releases the parsed data of \a page if it is cached.
+
+    \sa releaseAllPages(), setPageCacheLimit()
+*/
+void QPdfDocument::releasePage(int page)
+{
+    const QPdfMutexLocker lock(d.data());
+    const QPdfMutexLocker globalLock;
+
+    d->loadedPages.remove(page);
+}
+
+/*!
+    \since 5.11
+
+    Releases the parsed data of all cached pages.
+
+    \sa releasePage(), setPageCacheLimit()
+*/
+void QPdfDocument::releaseAllPages()
+{
+    const QPdfMutexLocker lock(d.data());
+    const QPdfMutexLocker globalLock;
+
+    d->loadedPages.clear();
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qpdfdocument.cpp"
@@ -39,12 +39,15 @@
 
 #include "qtpdfglobal.h"
 
+#include <QDeadlineTimer>
 #include <QImage>
 #include <QObject>
 #include <QPdfDocumentRenderOptions>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 
+class QAtomicInt;
 class QPdfDocumentPrivate;
 class QNetworkReply;
 
@@ -110,20 +113,48 @@ public:
     int pageCount() const;
 
     QSizeF pageSize(int page) const;
+    QVector<QSizeF> pageSizes() const;
 
     QImage render(int page, QSize imageSize, QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+    QImage render(int page, QSize imageSize, QPdfDocumentRenderOptions options, QDeadlineTimer deadline,
+                  const QAtomicInt *cancelled = nullptr, bool *complete = nullptr);
+    bool render(int page, QImage *image, QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+    bool render(int page, uchar *buffer, QSize imageSize, int bytesPerLine, QImage::Format format,
+                QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+    QImage renderRegion(int page, qreal scale, const QRect &clip,
+                        QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+
+    qint64 bitmapPoolLimit() const;
+    void setBitmapPoolLimit(qint64 bytes);
+
+    bool progressiveLoading() const;
+    void setProgressiveLoading(bool enabled);
+    bool isPageAvailable(int page) const;
+    void requestPage(int page);
+
+    qint64 spoolThreshold() const;
+    void setSpoolThreshold(qint64 bytes);
+
+    int pageCacheLimit() const;
+    void setPageCacheLimit(int limit);
+    void releasePage(int page);
+    void releaseAllPages();
 
 Q_SIGNALS:
     void passwordChanged();
     void passwordRequired();
     void statusChanged(QPdfDocument::Status status);
     void pageCountChanged(int pageCount);
+    void pageAvailable(int page);
 
 private:
     friend class QPdfBookmarkModelPrivate;
+    friend class QPdfDiskCachePrivate;
+    friend class QPdfPageRendererPrivate;
 
     Q_PRIVATE_SLOT(d, void _q_tryLoadingWithSizeFromContentHeader())
     Q_PRIVATE_SLOT(d, void _q_copyFromSequentialSourceDevice())
+    Q_PRIVATE_SLOT(d, void _q_checkComplete())
     QScopedPointer<QPdfDocumentPrivate> d;
 };
 
@@ -38,22 +38,66 @@
 #define QPDFDOCUMENT_P_H
 
 #include "qpdfdocument.h"
+#include "qpdfbitmappool_p.h"
+#include "qpdfblockcache_p.h"
+#include "qpdfchunkedbuffer_p.h"
+#include "qpdfrangeloader_p.h"
 #include "qpdfwriter.h"
 
 #include "public/fpdfview.h"
 #include "public/fpdf_dataavail.h"
 
-#include <qbuffer.h>
+#include <qbitarray.h>
+#include <qcache.h>
 #include <qmutex.h>
 #include <qnetworkreply.h>
 #include <qpointer.h>
+#include <qset.h>
+#include <qtemporaryfile.h>
 
 QT_BEGIN_NAMESPACE
 
+class QPdfDocumentPrivate;
+
+// Without arguments the locker guards the PDFium state that is shared by all
+// documents (library init/destroy, font mapper, FPDF_GetLastError()). Passing a
+// document locks only that document, so independent documents can be used from
+// different threads at the same time. When both are needed, the document lock
+// has to be taken first.
 class QPdfMutexLocker : public QMutexLocker
 {
 public:
     QPdfMutexLocker();
+    explicit QPdfMutexLocker(const QPdfDocumentPrivate *d);
+};
+
+// A parsed page, kept in QPdfDocumentPrivate::loadedPages
+struct QPdfLoadedPage
+{
+    explicit QPdfLoadedPage(FPDF_PAGE page) : page(page) {}
+    ~QPdfLoadedPage() { FPDF_ClosePage(page); }
+
+    FPDF_PAGE page;
+};
+
+// Gives access to a parsed page while the document lock is held. The page is taken from
+// QPdfDocumentPrivate::loadedPages or loaded and inserted there; if it cannot be cached,
+// it is closed again when the handle goes out of scope.
+class QPdfPageHandle
+{
+public:
+    QPdfPageHandle(QPdfDocumentPrivate *d, int index);
+    ~QPdfPageHandle();
+
+    FPDF_PAGE page() const { return m_page; }
+
+private:
+    Q_DISABLE_COPY(QPdfPageHandle)
+
+    // loading, rendering and closing a page use the fonts shared by all documents
+    QPdfMutexLocker m_globalLock;
+    FPDF_PAGE m_page;
+    bool m_owned;
 };
 
 class QPdfDocumentPrivate: public FPDF_FILEACCESS, public FX_FILEAVAIL, public FX_DOWNLOADHINTS
@@ -64,19 +108,42 @@ public:
 
     QPdfDocument *q;
 
+    mutable QMutex mutex;
+
     FPDF_AVAIL avail;
     FPDF_DOCUMENT doc;
     bool loadComplete;
+    bool progressiveLoading;
 
     QPointer<QIODevice> device;
     QScopedPointer<QIODevice> ownDevice;
-    QBuffer asyncBuffer;
+    const uchar *mappedData;
+    QPdfBlockCache blockCache;
+    QPdfChunkedBuffer asyncBuffer;    // data received from sequentialSourceDevice
+    qint64 spoolThreshold;
+    QScopedPointer<QTemporaryFile> spoolFile;
+    uchar *spoolData;                 // mapping of spoolFile, replaces asyncBuffer when set
+    qint64 spooledSize;
     QPointer<QIODevice> sequentialSourceDevice;
+    QScopedPointer<QPdfRangeLoader> rangeLoader;
     QByteArray password;
+    QString fileName;
+
+    // parsed pages, the cost of a page is the number of its page objects
+    QCache<int, QPdfLoadedPage> loadedPages;
+
+    // buffers of the images returned by QPdfDocument::render(), shared with those images
+    QPdfBitmapPool *bitmapPool;
 
     QPdfDocument::Status status;
     QPdfDocument::DocumentError lastError;
     int pageCount;
+    QVector<QSizeF> pageSizes;
+    QBitArray pageAvailability;
+    int firstUnavailablePage;
+
+    // pages whose data is fetched with range requests, see requestPage()
+    QSet<int> requestedPages;
 
     void clear();
 
@@ -85,15 +152,28 @@ public:
 
     void _q_tryLoadingWithSizeFromContentHeader();
     void initiateAsyncLoadWithTotalSizeKnown(quint64 totalSize);
+    bool openSpoolFile(qint64 totalSize);
+    qint64 receivedSize() const;
+    QByteArray readContent();
     void _q_copyFromSequentialSourceDevice();
     void tryLoadDocument();
     void checkComplete();
+    void _q_checkComplete();
+    bool updatePageAvailability(int page, QVector<int> *newlyAvailablePages, FX_DOWNLOADHINTS *hints);
+    bool isPageAvailable(int page) const;
+    void requestPage(int page);
     void setStatus(QPdfDocument::Status status);
 
+    static QRect renderRect(QSize imageSize, QPdfDocumentRenderOptions options);
+    bool renderPage(int page, uchar *buffer, int bytesPerLine, QImage::Format format,
+                    QSize imageSize, const QRect &region, QPdfDocumentRenderOptions options,
+                    QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever),
+                    const QAtomicInt *cancelled = nullptr, bool *complete = nullptr);
+
     static FPDF_BOOL fpdf_IsDataAvail(struct _FX_FILEAVAIL* pThis, size_t offset, size_t size);
     static int fpdf_GetBlock(void* param, unsigned long position, unsigned char* pBuf, unsigned long size);
     static void fpdf_AddSegment(struct _FX_DOWNLOADHINTS* pThis, size_t offset, size_t size);
-    void updateLastError();
+    void updateLastError(unsigned long error);
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfdocumentrenderoptions.h"
+
+#include <QDataStream>
+#include <QDebug>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \since 5.11
+
+    Restricts rendering to one tile of the page image. The page image is divided
+    into squares of \a tileSize pixels, and \a tile is the column and row of the
+    square to render. The tile size is rounded up to a power of two between 2 and
+    32768. The rendered image covers the tile's intersection with the page image,
+    so tiles at the right and bottom edges can be smaller than \a tileSize.
+
+    Passing a \a tileSize of \c 0 renders the whole page again. Tile sizes above
+    32768 and columns or rows outside the range 0 to 65535 cannot be represented;
+    they are rejected with a warning and the whole page is rendered as well.
+
+    Since the tile is part of the options, tile requests can be passed to
+    QPdfPageRenderer::requestPage() like any other request.
+
+    \sa tile(), tileSize(), tileRect(), QPdfDocument::render()
+*/
+void QPdfDocumentRenderOptions::setTile(QPoint tile, int tileSize)
+{
+    const int maximumExponent = 15;
+    const int maximumIndex = 0xffff;
+
+    bits.tileSizeExponent = 0;
+    bits.tileColumn = 0;
+    bits.tileRow = 0;
+
+    if (tileSize == 0)
+        return;
+
+    if (tileSize < 2 || tileSize > (1 << maximumExponent)) {
+        qWarning() << "QPdfDocumentRenderOptions: Unsupported tile size" << tileSize;
+        return;
+    }
+
+    if (tile.x() < 0 || tile.y() < 0 || tile.x() > maximumIndex || tile.y() > maximumIndex) {
+        qWarning() << "QPdfDocumentRenderOptions: Tile" << tile << "is out of range";
+        return;
+    }
+
+    quint32 exponent = 1;
+    while ((1 << exponent) < tileSize)
+        ++exponent;
+
+    bits.tileSizeExponent = exponent;
+    bits.tileColumn = quint32(tile.x());
+    bits.tileRow = quint32(tile.y());
+}
+
+#ifndef QT_NO_DATASTREAM
+/*!
+    \relates QPdfDocumentRenderOptions
+    \since 5.11
+
+    Writes the \a options to the \a stream.
+*/
+QDataStream &operator<<(QDataStream &stream, QPdfDocumentRenderOptions options)
+{
+    return stream << quint64(options.data);
+}
+
+/*!
+    \relates QPdfDocumentRenderOptions
+    \since 5.11
+
+    Reads render options from the \a stream into \a options.
+*/
+QDataStream &operator>>(QDataStream &stream, QPdfDocumentRenderOptions &options)
+{
+    quint64 data;
+    stream >> data;
+    options.data = data;
+    return stream;
+}
+#endif
+
+QT_END_NAMESPACE
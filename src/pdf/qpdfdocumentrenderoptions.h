@@ -38,11 +38,16 @@
 #define QPDFDOCUMENTRENDEROPTIONS_H
 
 #include "qpdfnamespace.h"
+#include "qtpdfglobal.h"
 
 #include <QtCore/QObject>
+#include <QtCore/QRect>
+#include <QtGui/QImage>
 
 QT_BEGIN_NAMESPACE
 
+class QDataStream;
+
 class QPdfDocumentRenderOptions
 {
 public:
@@ -54,15 +59,55 @@ public:
     Q_DECL_CONSTEXPR QPdf::RenderFlags renderFlags() const Q_DECL_NOTHROW { return static_cast<QPdf::RenderFlags>(bits.renderFlags); }
     Q_DECL_RELAXED_CONSTEXPR void setRenderFlags(QPdf::RenderFlags _renderFlags) Q_DECL_NOTHROW { bits.renderFlags = _renderFlags; }
 
+    QImage::Format imageFormat() const Q_DECL_NOTHROW
+    {
+        switch (bits.imageFormat) {
+        case 1: return QImage::Format_ARGB32_Premultiplied;
+        case 2: return QImage::Format_RGB32;
+        case 3: return QImage::Format_Grayscale8;
+        case 4: return QImage::Format_RGB888;
+        default: return QImage::Format_ARGB32;
+        }
+    }
+    void setImageFormat(QImage::Format _imageFormat) Q_DECL_NOTHROW
+    {
+        switch (_imageFormat) {
+        case QImage::Format_ARGB32_Premultiplied: bits.imageFormat = 1; break;
+        case QImage::Format_RGB32: bits.imageFormat = 2; break;
+        case QImage::Format_Grayscale8: bits.imageFormat = 3; break;
+        case QImage::Format_RGB888: bits.imageFormat = 4; break;
+        default: bits.imageFormat = 0; break;
+        }
+    }
+
+    Q_DECL_CONSTEXPR QPoint tile() const Q_DECL_NOTHROW { return QPoint(bits.tileColumn, bits.tileRow); }
+    Q_DECL_CONSTEXPR int tileSize() const Q_DECL_NOTHROW { return bits.tileSizeExponent ? 1 << bits.tileSizeExponent : 0; }
+    Q_DECL_CONSTEXPR QRect tileRect() const Q_DECL_NOTHROW
+    {
+        // setTile() keeps the column and row below 2^16 and the exponent at most 15,
+        // so the offsets, computed in 64 bits, always fit into an int
+        return bits.tileSizeExponent ? QRect(int(qint64(bits.tileColumn) << bits.tileSizeExponent),
+                                             int(qint64(bits.tileRow) << bits.tileSizeExponent),
+                                             tileSize(), tileSize())
+                                     : QRect();
+    }
+    Q_PDF_EXPORT void setTile(QPoint tile, int tileSize);
+
 private:
     friend Q_DECL_CONSTEXPR inline bool operator==(QPdfDocumentRenderOptions lhs, QPdfDocumentRenderOptions rhs) Q_DECL_NOTHROW;
-
+#ifndef QT_NO_DATASTREAM
+    friend Q_PDF_EXPORT QDataStream &operator<<(QDataStream &stream, QPdfDocumentRenderOptions options);
+    friend Q_PDF_EXPORT QDataStream &operator>>(QDataStream &stream, QPdfDocumentRenderOptions &options);
+#endif
 
     struct Bits {
-        quint32 renderFlags : 8;
-        quint32 rotation    : 3;
-        quint32 reserved    : 21;
-        quint32 reserved2   : 32;
+        quint32 renderFlags      : 8;
+        quint32 rotation         : 3;
+        quint32 tileSizeExponent : 4;
+        quint32 imageFormat      : 3;
+        quint32 reserved         : 14;
+        quint32 tileColumn       : 16;
+        quint32 tileRow          : 16;
     };
 
     union {
@@ -83,6 +128,11 @@ Q_DECL_CONSTEXPR inline bool operator!=(QPdfDocumentRenderOptions lhs, QPdfDocum
     return !operator==(lhs, rhs);
 }
 
+#ifndef QT_NO_DATASTREAM
+Q_PDF_EXPORT QDataStream &operator<<(QDataStream &stream, QPdfDocumentRenderOptions options);
+Q_PDF_EXPORT QDataStream &operator>>(QDataStream &stream, QPdfDocumentRenderOptions &options);
+#endif
+
 QT_END_NAMESPACE
 
 Q_DECLARE_METATYPE(QPdfDocumentRenderOptions)
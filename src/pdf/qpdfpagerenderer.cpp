@@ -36,11 +36,25 @@
 
 #include "qpdfpagerenderer.h"
 
+#include "qpdfdocument_p.h"
+#include "qpdfrendercache.h"
+#include "qpdfrenderprocess_p.h"
+#include "qpdfrenderstatistics_p.h"
+
 #include <private/qobject_p.h>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMap>
 #include <QMutex>
 #include <QPdfDocument>
 #include <QPointer>
 #include <QThread>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -52,19 +66,39 @@ public:
     RenderWorker();
     ~RenderWorker();
 
-    void setDocument(QPdfDocument *document);
+    void setDocument(QPdfDocument *document, const QString &fileName = QString());
+    void setRenderTimeBudget(int msecs);
+    void cancel(quint64 requestId);
 
 public Q_SLOTS:
     void requestPage(quint64 requestId, int page, QSize imageSize,
                      QPdfDocumentRenderOptions options);
 
 Q_SIGNALS:
+    // renderTime is in ns, finishedAt is QDeadlineTimer::current() in ns
     void pageRendered(int page, QSize imageSize, const QImage &image,
-                      QPdfDocumentRenderOptions options, quint64 requestId);
+                      QPdfDocumentRenderOptions options, quint64 requestId,
+                      qint64 renderTime, qint64 finishedAt);
 
 private:
+    void loadOwnDocument();
+
     QPointer<QPdfDocument> m_document;
     QMutex m_mutex;
+    QAtomicInt m_renderTimeBudget;
+
+    // the worker's own instance of m_document, which is loaded in the worker's thread
+    QScopedPointer<QPdfDocument> m_ownDocument;
+    QString m_fileName;
+    QString m_password;
+    int m_pageCacheLimit = 0;
+    qint64 m_bitmapPoolLimit = 0;
+    bool m_ownDocumentOutdated = false;
+
+    // cancel() can be called from any thread, while requestPage() runs in the worker's thread
+    QAtomicInteger<quint64> m_currentRequestId;
+    QAtomicInteger<quint64> m_cancelledRequestId;
+    QAtomicInt m_cancelled;
 };
 
 class QPdfPageRendererPrivate : public QObjectPrivate
@@ -75,34 +109,86 @@ public:
     QPdfPageRendererPrivate();
     ~QPdfPageRendererPrivate();
 
-    void handleNextRequest();
-    void requestFinished(int page, QSize imageSize, const QImage &image,
-                         QPdfDocumentRenderOptions options, quint64 requestId);
-
-    QPdfPageRenderer::RenderMode m_renderMode = QPdfPageRenderer::SingleThreadedRenderMode;
-    QPointer<QPdfDocument> m_document;
-
     struct PageRequest
     {
         quint64 id;
         int pageNumber;
         QSize imageSize;
         QPdfDocumentRenderOptions options;
+        QPdfPageRenderer::RequestPriority priority;
+        quint64 sequence;       // order among the queued requests of the same priority
+        bool cancelled;
+        RenderWorker *worker;   // nullptr for requests handed to the process pool
+        qint64 queuedAt;        // QDeadlineTimer::current() in ns
+        qint64 dispatchedAt;
+    };
+
+    struct PoolThread
+    {
+        QThread *thread;
+        RenderWorker *worker;
     };
 
-    QVector<PageRequest> m_requests;
-    QVector<PageRequest> m_pendingRequests;
+    // queued requests are ordered by priority first and by the order they were made or
+    // raised to their priority in second
+    typedef QPair<int, quint64> QueueKey;
+
+    void enqueue(const PageRequest &request);
+    PageRequest dequeue(quint64 requestId);
+    int maximumPendingRequests() const;
+
+    void startThreadPool();
+    void stopThreadPool();
+    void updatePoolDocuments();
+    RenderWorker *idleWorker() const;
+
+    void handleNextRequest();
+    void requestFinished(int page, QSize imageSize, const QImage &image,
+                         QPdfDocumentRenderOptions options, quint64 requestId,
+                         qint64 renderTime = -1, qint64 finishedAt = -1);
+
+    // QPdfRenderStatistics grants access to its counters to this class only
+    static qint64 now() { return QDeadlineTimer::current().deadlineNSecs(); }
+    void countRequest() { ++m_statistics.d->requestCount; }
+    void countCacheHit() { ++m_statistics.d->cacheHits; }
+    void countCancelled(int count = 1) { m_statistics.d->cancelledRequests += count; }
+    QPdfRenderStatistics statistics() const;
+    void emitStatistics();
+
+    QPdfPageRenderer::RenderMode m_renderMode = QPdfPageRenderer::SingleThreadedRenderMode;
+    int m_renderTimeBudget = -1;
+    bool m_supersedeRequests = false;
+    QPointer<QPdfDocument> m_document;
+    QPointer<QPdfRenderCache> m_renderCache;
+
+    QMap<QueueKey, PageRequest> m_requests;
+    QHash<quint64, QueueKey> m_requestKeys;     // id -> key of the queued requests
+    QMultiHash<int, quint64> m_queuedPages;     // page -> ids of the queued requests
+    QVector<PageRequest> m_pendingRequests;     // requests that are being rendered
     quint64 m_requestIdCounter = 1;
+    quint64 m_queueSequenceCounter = 1;
 
     QThread *m_renderThread = nullptr;
     QScopedPointer<RenderWorker> m_renderWorker;
+    QVector<PoolThread> m_threadPool;
+    quint64 m_threadPoolGeneration = 0;     // changes whenever the pool is stopped
+    QMetaObject::Connection m_documentStatusConnection;
+
+    QPdfRenderStatistics m_statistics;
+    QTimer m_statisticsTimer;
+    QScopedPointer<QPdfRenderProcessPool> m_processPool;
 };
 
 Q_DECLARE_TYPEINFO(QPdfPageRendererPrivate::PageRequest, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QPdfPageRendererPrivate::PoolThread, Q_PRIMITIVE_TYPE);
 
 
 RenderWorker::RenderWorker()
     : m_document(nullptr)
+    , m_renderTimeBudget(-1)
+    , m_currentRequestId(0)
+    , m_cancelledRequestId(0)
+    , m_cancelled(0)
 {
 }
 
@@ -110,14 +196,62 @@ RenderWorker::~RenderWorker()
 {
 }
 
-void RenderWorker::setDocument(QPdfDocument *document)
+// With a \a fileName, the worker renders from its own instance of the \a document, which
+// is loaded from that file in the worker's thread.
+void RenderWorker::setDocument(QPdfDocument *document, const QString &fileName)
 {
-    const QMutexLocker locker(&m_mutex);
+    {
+        const QMutexLocker locker(&m_mutex);
+
+        m_document = document;
+        m_fileName = document ? fileName : QString();
+        m_password = document ? document->password() : QString();
+        m_pageCacheLimit = document ? document->pageCacheLimit() : 0;
+        m_bitmapPoolLimit = document ? document->bitmapPoolLimit() : 0;
+        m_ownDocumentOutdated = true;
+    }
+
+    // load or release the instance right away instead of with the next request
+    QMetaObject::invokeMethod(this, [this]() {
+        const QMutexLocker locker(&m_mutex);
+        loadOwnDocument();
+    }, Qt::QueuedConnection);
+}
 
-    if (m_document == document)
+// Called in the worker's thread with m_mutex locked. Documents that have not been loaded
+// from a file, or whose file cannot be loaded again, are shared with the other workers.
+void RenderWorker::loadOwnDocument()
+{
+    if (!m_ownDocumentOutdated)
         return;
 
-    m_document = document;
+    m_ownDocumentOutdated = false;
+    m_ownDocument.reset();
+
+    if (m_fileName.isEmpty())
+        return;
+
+    // the instances are loaded from the same file, whose mapping shares the pages in memory
+    QScopedPointer<QPdfDocument> document(new QPdfDocument);
+    document->setPassword(m_password);
+    document->setPageCacheLimit(m_pageCacheLimit);
+    document->setBitmapPoolLimit(m_bitmapPoolLimit);
+
+    if (document->load(m_fileName) == QPdfDocument::NoError && document->status() == QPdfDocument::Ready)
+        m_ownDocument.swap(document);
+}
+
+void RenderWorker::setRenderTimeBudget(int msecs)
+{
+    m_renderTimeBudget.store(msecs);
+}
+
+// Interrupts the request if it is being rendered, or skips it once it is handled.
+void RenderWorker::cancel(quint64 requestId)
+{
+    m_cancelledRequestId.fetchAndStoreOrdered(requestId);
+    if (m_currentRequestId.loadAcquire() == requestId)
+        m_cancelled.fetchAndStoreOrdered(1);
 }
 
 void RenderWorker::requestPage(quint64 requestId, int pageNumber, QSize imageSize,
@@ -125,12 +259,27 @@ void RenderWorker::requestPage(quint64 requestId, int pageNumber, QSize imageSiz
 {
     const QMutexLocker locker(&m_mutex);
 
-    if (!m_document || m_document->status() != QPdfDocument::Ready)
-        return;
+    m_cancelled.fetchAndStoreOrdered(0);
+    m_currentRequestId.fetchAndStoreOrdered(requestId);
+
+    QImage image;
+    const qint64 startedAt = QDeadlineTimer::current().deadlineNSecs();
+    if (m_cancelledRequestId.loadAcquire() != requestId && m_document && m_document->status() == QPdfDocument::Ready) {
+        loadOwnDocument();
+        QPdfDocument *document = m_ownDocument ? m_ownDocument.data() : m_document.data();
+
+        const int renderTimeBudget = m_renderTimeBudget.load();
+        const QDeadlineTimer deadline = renderTimeBudget < 0 ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                                             : QDeadlineTimer(renderTimeBudget);
+
+        image = document->render(pageNumber, imageSize, options, deadline, &m_cancelled);
+    }
 
-    const QImage image = m_document->render(pageNumber, imageSize, options);
+    m_currentRequestId.fetchAndStoreOrdered(0);
 
-    emit pageRendered(pageNumber, imageSize, image, options, requestId);
+    // every request is answered, so that the renderer can move on to the next one
+    const qint64 finishedAt = QDeadlineTimer::current().deadlineNSecs();
+    emit pageRendered(pageNumber, imageSize, image, options, requestId, finishedAt - startedAt, finishedAt);
 }
 
 
@@ -142,33 +291,235 @@ QPdfPageRendererPrivate::QPdfPageRendererPrivate()
 
 QPdfPageRendererPrivate::~QPdfPageRendererPrivate()
 {
+    for (const PageRequest &request : qAsConst(m_pendingRequests)) {
+        if (request.worker)
+            request.worker->cancel(request.id);
+    }
+
     if (m_renderThread) {
         m_renderThread->quit();
         m_renderThread->wait();
     }
+
+    stopThreadPool();
 }
 
-void QPdfPageRendererPrivate::handleNextRequest()
+void QPdfPageRendererPrivate::enqueue(const PageRequest &request)
+{
+    const QueueKey key(request.priority, request.sequence);
+    m_requests.insert(key, request);
+    m_requestKeys.insert(request.id, key);
+    m_queuedPages.insert(request.pageNumber, request.id);
+}
+
+QPdfPageRendererPrivate::PageRequest QPdfPageRendererPrivate::dequeue(quint64 requestId)
+{
+    const PageRequest request = m_requests.take(m_requestKeys.take(requestId));
+    m_queuedPages.remove(request.pageNumber, requestId);
+
+    return request;
+}
+
+int QPdfPageRendererPrivate::maximumPendingRequests() const
+{
+    // Only as many requests are handed out as can be worked on at the same time, the others
+    // stay in the queue where they can still be cancelled or overtaken by more important ones.
+    if (m_processPool && m_document && m_processPool->canRender(m_document->d->fileName))
+        return m_processPool->processCount();
+
+    if (!m_threadPool.isEmpty())
+        return m_threadPool.size();
+
+    return 1;
+}
+
+void QPdfPageRendererPrivate::startThreadPool()
+{
+    const int threadCount = qMax(1, QThread::idealThreadCount());
+    const quint64 generation = m_threadPoolGeneration;
+
+    m_threadPool.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        PoolThread poolThread;
+        poolThread.thread = new QThread;
+        poolThread.worker = new RenderWorker;
+
+        poolThread.worker->setRenderTimeBudget(m_renderTimeBudget);
+        QObject::connect(poolThread.worker, &RenderWorker::pageRendered, q_func(),
+                         [this, generation](int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options,
+                                            quint64 requestId, qint64 renderTime, qint64 finishedAt) {
+                             // the requests of a stopped pool have been queued again, and the results
+                             // of their interrupted renders may only arrive afterwards
+                             if (generation == m_threadPoolGeneration)
+                                 requestFinished(page, imageSize, image, options, requestId, renderTime, finishedAt);
+                         });
+
+        poolThread.worker->moveToThread(poolThread.thread);
+        poolThread.thread->start();
+
+        m_threadPool.append(poolThread);
+    }
+
+    updatePoolDocuments();
+}
+
+void QPdfPageRendererPrivate::stopThreadPool()
 {
-    if (m_requests.isEmpty())
+    if (m_threadPool.isEmpty())
         return;
 
-    const PageRequest request = m_requests.takeFirst();
-    m_pendingRequests.append(request);
+    ++m_threadPoolGeneration;
+
+    // interrupt the pages that are being rendered, so that waiting for the threads does not
+    // block until they are done; the requests are queued again below
+    for (const PageRequest &request : qAsConst(m_pendingRequests)) {
+        if (request.worker && request.worker != m_renderWorker.data())
+            request.worker->cancel(request.id);
+    }
+
+    for (const PoolThread &poolThread : qAsConst(m_threadPool)) {
+        // the instances of the document that have not been loaded yet are not needed anymore
+        poolThread.worker->setDocument(nullptr);
+
+        poolThread.thread->quit();
+        poolThread.thread->wait();
+
+        delete poolThread.worker;
+        delete poolThread.thread;
+    }
+    m_threadPool.clear();
+
+    // the requests that have not been answered yet are lost with their workers, so queue them again
+    QVector<PageRequest> pendingRequests;
+    for (const PageRequest &request : qAsConst(m_pendingRequests)) {
+        if (!request.worker)
+            pendingRequests.append(request);
+        else if (!request.cancelled && request.worker != m_renderWorker.data())
+            enqueue(request);
+    }
+    m_pendingRequests = pendingRequests;
+}
+
+// Gives every worker of the pool its own instance of the document, so that a worker does
+// not wait for the document's lock while another one renders. PDFium's fonts are shared by
+// all instances though, so loading and rendering the pages still take turns.
+// The workers load their instances themselves, so that the GUI thread does not wait for them.
+void QPdfPageRendererPrivate::updatePoolDocuments()
+{
+    for (const PoolThread &poolThread : qAsConst(m_threadPool)) {
+        // the pages rendered from the old instance are outdated, and setDocument() waits for them
+        for (PageRequest &request : m_pendingRequests) {
+            if (request.worker == poolThread.worker && !request.cancelled) {
+                request.cancelled = true;
+                countCancelled();
+                poolThread.worker->cancel(request.id);
+            }
+        }
+
+        if (m_document && m_document->status() == QPdfDocument::Ready)
+            poolThread.worker->setDocument(m_document, m_document->d->fileName);
+        else
+            poolThread.worker->setDocument(nullptr);
+    }
+}
+
+RenderWorker *QPdfPageRendererPrivate::idleWorker() const
+{
+    for (const PoolThread &poolThread : m_threadPool) {
+        const bool busy = std::any_of(m_pendingRequests.cbegin(), m_pendingRequests.cend(),
+                                      [&poolThread](const PageRequest &request) { return request.worker == poolThread.worker; });
+        if (!busy)
+            return poolThread.worker;
+    }
+
+    return nullptr;
+}
 
-    QMetaObject::invokeMethod(m_renderWorker.data(), "requestPage", Qt::QueuedConnection,
-                              Q_ARG(quint64, request.id), Q_ARG(int, request.pageNumber),
-                              Q_ARG(QSize, request.imageSize), Q_ARG(QPdfDocumentRenderOptions,
-                              request.options));
+void QPdfPageRendererPrivate::handleNextRequest()
+{
+    while (!m_requests.isEmpty() && m_pendingRequests.size() < maximumPendingRequests()) {
+        PageRequest request = dequeue(m_requests.first().id);
+        request.dispatchedAt = now();
+        m_statistics.d->record(QPdfRenderStatistics::QueueWait, request.dispatchedAt - request.queuedAt);
+
+        if (m_processPool && m_document && m_processPool->canRender(m_document->d->fileName)) {
+            request.worker = nullptr;
+            m_pendingRequests.append(request);
+
+            m_processPool->requestPage(request.id, m_document->d->fileName, m_document->d->password,
+                                       request.pageNumber, request.imageSize, request.options);
+            continue;
+        }
+
+        // documents that have not been loaded from a file are rendered in process; the workers
+        // of the thread pool take the next request as soon as they are done with their previous
+        // one, so the pool stays busy as long as there are requests in the queue
+        request.worker = m_threadPool.isEmpty() ? m_renderWorker.data() : idleWorker();
+        m_pendingRequests.append(request);
+
+        QMetaObject::invokeMethod(request.worker, "requestPage", Qt::QueuedConnection,
+                                  Q_ARG(quint64, request.id), Q_ARG(int, request.pageNumber),
+                                  Q_ARG(QSize, request.imageSize), Q_ARG(QPdfDocumentRenderOptions,
+                                  request.options));
+    }
 }
 
-void QPdfPageRendererPrivate::requestFinished(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId)
+void QPdfPageRendererPrivate::requestFinished(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId,
+                                              qint64 renderTime, qint64 finishedAt)
 {
+    Q_Q(QPdfPageRenderer);
+
     const auto it = std::find_if(m_pendingRequests.begin(), m_pendingRequests.end(),
-                                 [page, imageSize, options](const PageRequest &request){ return request.pageNumber == page && request.imageSize == imageSize && request.options == options; });
+                                 [requestId](const PageRequest &request){ return request.id == requestId; });
+
+    // results of requests that have been cancelled or requeued are dropped
+    if (it == m_pendingRequests.end())
+        return;
+
+    const bool cancelled = it->cancelled;
+    const bool mayBeIncomplete = it->worker && m_renderTimeBudget >= 0;
+    const qint64 dispatchedAt = it->dispatchedAt;
+    m_pendingRequests.erase(it);
+
+    // the helper processes do not report their times, their transfer counts as rendering
+    const qint64 receivedAt = now();
+    if (finishedAt < 0) {
+        m_statistics.d->record(QPdfRenderStatistics::Render, receivedAt - dispatchedAt);
+    } else {
+        if (renderTime >= 0)
+            m_statistics.d->record(QPdfRenderStatistics::Render, renderTime);
+        m_statistics.d->record(QPdfRenderStatistics::Delivery, receivedAt - finishedAt);
+    }
 
-    if (it != m_pendingRequests.end())
-        m_pendingRequests.erase(it);
+    if (!cancelled) {
+        ++m_statistics.d->completedRequests;
+
+        // pages that ran out of their time budget must not be served from the cache later on
+        if (m_renderCache && m_renderCache->document() == m_document && !mayBeIncomplete)
+            m_renderCache->insert(page, imageSize, image, options);
+
+        emit q->pageRendered(page, imageSize, image, options, requestId);
+    }
+
+    handleNextRequest();
+}
+
+QPdfRenderStatistics QPdfPageRendererPrivate::statistics() const
+{
+    QPdfRenderStatistics statistics = m_statistics;
+    statistics.d->queuedRequests = m_requests.size();
+    statistics.d->pendingRequests = std::count_if(m_pendingRequests.cbegin(), m_pendingRequests.cend(),
+                                                  [](const PageRequest &request) { return !request.cancelled; });
+    statistics.d->endTime = now();
+
+    return statistics;
+}
+
+void QPdfPageRendererPrivate::emitStatistics()
+{
+    Q_Q(QPdfPageRenderer);
+
+    emit q->statisticsUpdated(statistics());
 }
 
 /*!
@@ -180,9 +531,15 @@ void QPdfPageRendererPrivate::requestFinished(int page, QSize imageSize, const Q
 
     The QPdfPageRenderer contains a queue that collects all render requests that are invoked through
     requestPage(). Depending on the configured RenderMode the QPdfPageRenderer processes this queue
-    in the main UI thread on next event loop invocation (SingleThreadedRenderMode) or in a separate worker thread
-    (MultiThreadedRenderMode) and emits the result through the pageRendered() signal for each request once
-    the rendering is done.
+    in the main UI thread on next event loop invocation (SingleThreadedRenderMode), in a separate worker thread
+    (MultiThreadedRenderMode), in a pool of worker threads (ThreadPoolRenderMode) or in a pool of helper
+    processes (MultiProcessRenderMode) and emits the result
+    through the pageRendered() signal for each request once the rendering is done.
+
+    Requests are taken from the queue by their RequestPriority, and only as many
+    are handed out as can be rendered at the same time, so requests that are no
+    longer needed can be withdrawn with cancelRequest() or cancelAll() before any
+    work is spent on them.
 
     \sa QPdfDocument
 */
@@ -197,13 +554,15 @@ QPdfPageRenderer::QPdfPageRenderer(QObject *parent)
     Q_D(QPdfPageRenderer);
 
     qRegisterMetaType<QPdfDocumentRenderOptions>();
+    qRegisterMetaType<QPdfRenderStatistics>();
 
     connect(d->m_renderWorker.data(), &RenderWorker::pageRendered, this,
-            [this,d](int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId) {
-                d->requestFinished(page, imageSize, image, options, requestId);
-                emit pageRendered(page, imageSize, image, options, requestId);
-                d->handleNextRequest();
+            [d](int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId,
+                qint64 renderTime, qint64 finishedAt) {
+                d->requestFinished(page, imageSize, image, options, requestId, renderTime, finishedAt);
            });
+
+    connect(&d->m_statisticsTimer, &QTimer::timeout, this, [d]() { d->emitStatistics(); });
 }
 
 /*!
@@ -220,6 +579,17 @@ QPdfPageRenderer::~QPdfPageRenderer()
 
     \value MultiThreadedRenderMode All pages are rendered in a separate worker thread.
     \value SingleThreadedRenderMode All pages are rendered in the main UI thread (default).
+    \value MultiProcessRenderMode All pages are rendered by a pool of helper processes, one per
+           CPU core. The rendered images are transferred through shared memory. If a helper
+           process crashes or does not answer within 30 seconds, it is restarted and the request
+           is retried once, a page that keeps failing is delivered as an empty image. Documents that have not been loaded from a
+           local file are rendered in the main UI thread. This value was introduced in Qt 5.11.
+    \value ThreadPoolRenderMode All pages are rendered by a pool of worker threads, one per
+           CPU core. Each worker renders from its own instance of a document that has been
+           loaded from a local file; other documents are shared by the workers. Since PDFium
+           shares its fonts between all documents of a process, the workers take turns
+           while loading and rendering a page, only the MultiProcessRenderMode renders pages
+           truly in parallel. This value was introduced in Qt 5.11.
 
     \sa renderMode(), setRenderMode()
 */
@@ -260,11 +630,7 @@ void QPdfPageRenderer::setRenderMode(RenderMode mode)
     d->m_renderMode = mode;
     emit renderModeChanged(d->m_renderMode);
 
-    if (d->m_renderMode == MultiThreadedRenderMode) {
-        d->m_renderThread = new QThread;
-        d->m_renderWorker->moveToThread(d->m_renderThread);
-        d->m_renderThread->start();
-    } else {
+    if (d->m_renderThread) {
         d->m_renderThread->quit();
         d->m_renderThread->wait();
         delete d->m_renderThread;
@@ -273,6 +639,35 @@ void QPdfPageRenderer::setRenderMode(RenderMode mode)
         // pulling the object from another thread should be fine, once that thread is deleted
         d->m_renderWorker->moveToThread(this->thread());
     }
+
+    d->stopThreadPool();
+
+    if (d->m_processPool) {
+        d->m_processPool.reset();
+
+        // the results of the requests still running in the helper processes are lost, so queue them again
+        for (const QPdfPageRendererPrivate::PageRequest &request : qAsConst(d->m_pendingRequests)) {
+            if (!request.cancelled)
+                d->enqueue(request);
+        }
+        d->m_pendingRequests.clear();
+    }
+
+    if (d->m_renderMode == MultiThreadedRenderMode) {
+        d->m_renderThread = new QThread;
+        d->m_renderWorker->moveToThread(d->m_renderThread);
+        d->m_renderThread->start();
+    } else if (d->m_renderMode == MultiProcessRenderMode) {
+        d->m_processPool.reset(new QPdfRenderProcessPool(QThread::idealThreadCount()));
+        connect(d->m_processPool.data(), &QPdfRenderProcessPool::pageRendered, this,
+                [d](int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId) {
+                    d->requestFinished(page, imageSize, image, options, requestId);
+                });
+    } else if (d->m_renderMode == ThreadPoolRenderMode) {
+        d->startThreadPool();
+    }
+
+    d->handleNextRequest();
 }
 
 /*!
@@ -300,6 +695,8 @@ QPdfDocument* QPdfPageRenderer::document() const
 /*!
     Sets the \a document this object renders the pages from.
 
+    All requests for the previous document are cancelled.
+
     \sa QPdfDocument
 */
 void QPdfPageRenderer::setDocument(QPdfDocument *document)
@@ -309,36 +706,322 @@ void QPdfPageRenderer::setDocument(QPdfDocument *document)
     if (d->m_document == document)
         return;
 
+    cancelAll();
+
+    disconnect(d->m_documentStatusConnection);
+
     d->m_document = document;
     emit documentChanged(d->m_document);
 
     d->m_renderWorker->setDocument(d->m_document);
+    d->updatePoolDocuments();
+
+    if (d->m_document) {
+        d->m_documentStatusConnection = connect(d->m_document, &QPdfDocument::statusChanged, this,
+                                                [d]() { d->updatePoolDocuments(); });
+    }
+}
+
+/*!
+    \property QPdfPageRenderer::renderTimeBudget
+    \brief the time in milliseconds a single page may take to render
+    \since 5.11
+
+    A page that takes longer is delivered through pageRendered() as far as it has
+    been rendered when the time runs out, so that one very complex page cannot hold
+    up all the requests queued after it. A negative value, the default, means that
+    pages are always rendered completely. The budget is not applied in the
+    MultiProcessRenderMode.
+
+    Changing the document interrupts the page that is being rendered in the
+    MultiThreadedRenderMode; its request is answered with an empty image.
+*/
+
+/*!
+    \since 5.11
+
+    Returns the time in milliseconds a single page may take to render.
+
+    \sa setRenderTimeBudget()
+*/
+int QPdfPageRenderer::renderTimeBudget() const
+{
+    Q_D(const QPdfPageRenderer);
+
+    return d->m_renderTimeBudget;
 }
 
+/*!
+    \since 5.11
+
+    Sets the time in milliseconds a single page may take to render to \a msecs.
+
+    \sa renderTimeBudget()
+*/
+void QPdfPageRenderer::setRenderTimeBudget(int msecs)
+{
+    Q_D(QPdfPageRenderer);
+
+    msecs = qMax(-1, msecs);
+    if (d->m_renderTimeBudget == msecs)
+        return;
+
+    d->m_renderTimeBudget = msecs;
+    d->m_renderWorker->setRenderTimeBudget(msecs);
+    for (const QPdfPageRendererPrivate::PoolThread &poolThread : qAsConst(d->m_threadPool))
+        poolThread.worker->setRenderTimeBudget(msecs);
+    emit renderTimeBudgetChanged(d->m_renderTimeBudget);
+}
+
+/*!
+    \property QPdfPageRenderer::supersedeRequests
+    \brief whether a request replaces the queued requests for the same page in other sizes
+    \since 5.11
+
+    While zooming, a page is typically requested in a series of sizes of which only
+    the last one is still interesting once the rendering starts. If this property is
+    \c true, requestPage() removes the queued requests for the same page with a
+    different image size, as if cancelRequest() had been called for them. Requests
+    that are already being rendered, and requests for other tiles of the page in
+    the same size, are kept.
+
+    By default, this property is \c false.
+*/
+
+/*!
+    \since 5.11
+
+    Returns whether a request replaces the queued requests for the same page in other sizes.
+
+    \sa setSupersedeRequests()
+*/
+bool QPdfPageRenderer::supersedeRequests() const
+{
+    Q_D(const QPdfPageRenderer);
+
+    return d->m_supersedeRequests;
+}
+
+/*!
+    \since 5.11
+
+    Sets whether a request replaces the queued requests for the same page in other
+    sizes to \a enabled.
+
+    \sa supersedeRequests()
+*/
+void QPdfPageRenderer::setSupersedeRequests(bool enabled)
+{
+    Q_D(QPdfPageRenderer);
+
+    if (d->m_supersedeRequests == enabled)
+        return;
+
+    d->m_supersedeRequests = enabled;
+    emit supersedeRequestsChanged(d->m_supersedeRequests);
+}
+
+/*!
+    \property QPdfPageRenderer::renderCache
+    \brief the cache the rendered pages are shared through
+    \since 5.11
+
+    Requests for pages that are in the cache are answered from it without rendering
+    them again, and the rendered pages are inserted into it, as long as the cache
+    belongs to the same document as the renderer. Pages that are rendered with a
+    renderTimeBudget are not inserted, since they might be incomplete.
+
+    By default, this property is \c nullptr.
+
+    \sa QPdfRenderCache
+*/
+
+/*!
+    \since 5.11
+
+    Returns the cache the rendered pages are shared through.
+
+    \sa setRenderCache()
+*/
+QPdfRenderCache *QPdfPageRenderer::renderCache() const
+{
+    Q_D(const QPdfPageRenderer);
+
+    return d->m_renderCache;
+}
+
+/*!
+    \since 5.11
+
+    Sets the \a cache the rendered pages are shared through.
+
+    \sa renderCache()
+*/
+void QPdfPageRenderer::setRenderCache(QPdfRenderCache *cache)
+{
+    Q_D(QPdfPageRenderer);
+
+    if (d->m_renderCache == cache)
+        return;
+
+    d->m_renderCache = cache;
+    emit renderCacheChanged(d->m_renderCache);
+}
+
+/*!
+    \property QPdfPageRenderer::statisticsInterval
+    \brief the interval in milliseconds in which statisticsUpdated() is emitted
+    \since 5.11
+
+    A value of 0, the default, disables the signal. The statistics are collected
+    either way and can be read with statistics() at any time.
+*/
+
+/*!
+    \since 5.11
+
+    Returns the interval in milliseconds in which statisticsUpdated() is emitted.
+
+    \sa setStatisticsInterval()
+*/
+int QPdfPageRenderer::statisticsInterval() const
+{
+    Q_D(const QPdfPageRenderer);
+
+    return d->m_statisticsTimer.isActive() ? d->m_statisticsTimer.interval() : 0;
+}
+
+/*!
+    \since 5.11
+
+    Sets the interval in milliseconds in which statisticsUpdated() is emitted to \a msecs.
+
+    \sa statisticsInterval()
+*/
+void QPdfPageRenderer::setStatisticsInterval(int msecs)
+{
+    Q_D(QPdfPageRenderer);
+
+    msecs = qMax(0, msecs);
+    if (statisticsInterval() == msecs)
+        return;
+
+    if (msecs > 0)
+        d->m_statisticsTimer.start(msecs);
+    else
+        d->m_statisticsTimer.stop();
+
+    emit statisticsIntervalChanged(msecs);
+}
+
+/*!
+    \since 5.11
+
+    Returns the statistics of the requests since the renderer has been created or
+    resetStatistics() has been called, together with the current number of queued
+    and pending requests.
+
+    \sa statisticsUpdated()
+*/
+QPdfRenderStatistics QPdfPageRenderer::statistics() const
+{
+    Q_D(const QPdfPageRenderer);
+
+    return d->statistics();
+}
+
+/*!
+    \since 5.11
+
+    Restarts the collection of the statistics.
+
+    \sa statistics()
+*/
+void QPdfPageRenderer::resetStatistics()
+{
+    Q_D(QPdfPageRenderer);
+
+    d->m_statistics = QPdfRenderStatistics();
+}
+
+/*!
+    \fn void QPdfPageRenderer::statisticsUpdated(const QPdfRenderStatistics &statistics)
+    \since 5.11
+
+    This signal is emitted every statisticsInterval() milliseconds with the current \a statistics.
+*/
+
+/*!
+    \enum QPdfPageRenderer::RequestPriority
+    \since 5.11
+
+    This enum describes how urgent a render request is. Queued requests are
+    rendered in the order of their priority, and in the order they were made
+    within the same priority.
+
+    \value VisiblePriority The page is visible and should be rendered as soon as possible (default).
+    \value PrefetchPriority The page is likely to become visible soon.
+    \value BackgroundPriority The page is rendered ahead of time, e.g. to fill a cache.
+
+    \sa requestPage()
+*/
+
 /*!
     Requests the renderer to render the page \a pageNumber into a QImage of size \a imageSize
-    according to the provided \a options.
+    according to the provided \a options, with the given \a priority.
 
     Once the rendering is done the pageRendered() signal is emitted with the result as parameters.
 
     The return value is an ID that uniquely identifies the render request. If a request with the
-    same parameters is still in the queue, the ID of that queued request is returned.
+    same parameters is still queued or being rendered, the ID of that request is returned, and
+    its priority is raised to \a priority if that is more urgent. Pages found in the
+    renderCache() are delivered without being rendered again.
+
+    \sa cancelRequest()
 */
 quint64 QPdfPageRenderer::requestPage(int pageNumber, QSize imageSize,
-                                      QPdfDocumentRenderOptions options)
+                                      QPdfDocumentRenderOptions options, RequestPriority priority)
 {
     Q_D(QPdfPageRenderer);
 
     if (!d->m_document || d->m_document->status() != QPdfDocument::Ready)
         return 0;
 
-    for (const auto request : qAsConst(d->m_pendingRequests)) {
-        if (request.pageNumber == pageNumber
+    for (const auto &request : qAsConst(d->m_pendingRequests)) {
+        if (!request.cancelled
+            && request.pageNumber == pageNumber
             && request.imageSize == imageSize
             && request.options == options)
             return request.id;
     }
 
+    if (d->m_supersedeRequests) {
+        const QList<quint64> queuedIds = d->m_queuedPages.values(pageNumber);
+        for (quint64 queuedId : queuedIds) {
+            if (d->m_requests.value(d->m_requestKeys.value(queuedId)).imageSize != imageSize) {
+                d->dequeue(queuedId);
+                d->countCancelled();
+            }
+        }
+    }
+
+    const QList<quint64> queuedIds = d->m_queuedPages.values(pageNumber);
+    for (quint64 queuedId : queuedIds) {
+        const QPdfPageRendererPrivate::PageRequest &request = d->m_requests[d->m_requestKeys.value(queuedId)];
+        if (request.imageSize != imageSize || request.options != options)
+            continue;
+
+        if (priority < request.priority) {
+            QPdfPageRendererPrivate::PageRequest raisedRequest = d->dequeue(queuedId);
+            // the raised request queues up behind those that already have its new priority
+            raisedRequest.priority = priority;
+            raisedRequest.sequence = d->m_queueSequenceCounter++;
+            d->enqueue(raisedRequest);
+        }
+
+        return queuedId;
+    }
+
     const auto id = d->m_requestIdCounter++;
 
     QPdfPageRendererPrivate::PageRequest request;
@@ -346,14 +1029,98 @@ quint64 QPdfPageRenderer::requestPage(int pageNumber, QSize imageSize,
     request.pageNumber = pageNumber;
     request.imageSize = imageSize;
     request.options = options;
+    request.priority = priority;
+    request.sequence = d->m_queueSequenceCounter++;
+    request.cancelled = false;
+    request.worker = nullptr;
+    request.queuedAt = QPdfPageRendererPrivate::now();
+    request.dispatchedAt = request.queuedAt;
+
+    d->countRequest();
+
+    if (d->m_renderCache && d->m_renderCache->document() == d->m_document) {
+        const QImage image = d->m_renderCache->image(pageNumber, imageSize, options);
+        if (!image.isNull()) {
+            // cached pages are still delivered asynchronously and can be cancelled until then
+            d->countCacheHit();
+            d->m_pendingRequests.append(request);
+            QMetaObject::invokeMethod(this, [d, request, image]() {
+                d->requestFinished(request.pageNumber, request.imageSize, image, request.options, request.id,
+                                   -1, request.queuedAt);
+            }, Qt::QueuedConnection);
+
+            return id;
+        }
+    }
 
-    d->m_requests.append(request);
+    d->enqueue(request);
 
     d->handleNextRequest();
 
     return id;
 }
 
+/*!
+    \since 5.11
+
+    Cancels the request with the ID \a requestId.
+
+    A queued request is removed from the queue. A request that is being rendered
+    is interrupted if possible. In both cases pageRendered() is not emitted for it.
+
+    Returns \c true if the request was still queued or being rendered.
+
+    \sa cancelAll(), requestPage()
+*/
+bool QPdfPageRenderer::cancelRequest(quint64 requestId)
+{
+    Q_D(QPdfPageRenderer);
+
+    if (d->m_requestKeys.contains(requestId)) {
+        d->dequeue(requestId);
+        d->countCancelled();
+        return true;
+    }
+
+    for (auto &request : d->m_pendingRequests) {
+        if (request.id == requestId && !request.cancelled) {
+            request.cancelled = true;
+            d->countCancelled();
+            if (request.worker)
+                request.worker->cancel(requestId);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    \since 5.11
+
+    Cancels all requests that are queued or being rendered.
+
+    \sa cancelRequest()
+*/
+void QPdfPageRenderer::cancelAll()
+{
+    Q_D(QPdfPageRenderer);
+
+    d->countCancelled(d->m_requests.size());
+    d->m_requests.clear();
+    d->m_requestKeys.clear();
+    d->m_queuedPages.clear();
+
+    for (auto &request : d->m_pendingRequests) {
+        if (!request.cancelled) {
+            request.cancelled = true;
+            d->countCancelled();
+            if (request.worker)
+                request.worker->cancel(request.id);
+        }
+    }
+}
+
 QT_END_NAMESPACE
 
 #include "qpdfpagerenderer.moc"
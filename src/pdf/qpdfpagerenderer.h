@@ -41,12 +41,14 @@
 
 #include <QObject>
 #include <QPdfDocumentRenderOptions>
+#include <QPdfRenderStatistics>
 #include <QSize>
 
 QT_BEGIN_NAMESPACE
 
 class QPdfDocument;
 class QPdfPageRendererPrivate;
+class QPdfRenderCache;
 
 class Q_PDF_EXPORT QPdfPageRenderer : public QObject
 {
@@ -54,15 +56,29 @@ class Q_PDF_EXPORT QPdfPageRenderer : public QObject
 
     Q_PROPERTY(QPdfDocument* document READ document WRITE setDocument NOTIFY documentChanged)
     Q_PROPERTY(RenderMode renderMode READ renderMode WRITE setRenderMode NOTIFY renderModeChanged)
+    Q_PROPERTY(int renderTimeBudget READ renderTimeBudget WRITE setRenderTimeBudget NOTIFY renderTimeBudgetChanged)
+    Q_PROPERTY(bool supersedeRequests READ supersedeRequests WRITE setSupersedeRequests NOTIFY supersedeRequestsChanged)
+    Q_PROPERTY(QPdfRenderCache* renderCache READ renderCache WRITE setRenderCache NOTIFY renderCacheChanged)
+    Q_PROPERTY(int statisticsInterval READ statisticsInterval WRITE setStatisticsInterval NOTIFY statisticsIntervalChanged)
 
 public:
     enum RenderMode
     {
         MultiThreadedRenderMode,
-        SingleThreadedRenderMode
+        SingleThreadedRenderMode,
+        MultiProcessRenderMode,
+        ThreadPoolRenderMode
     };
     Q_ENUM(RenderMode)
 
+    enum RequestPriority
+    {
+        VisiblePriority,
+        PrefetchPriority,
+        BackgroundPriority
+    };
+    Q_ENUM(RequestPriority)
+
     explicit QPdfPageRenderer(QObject *parent = nullptr);
     ~QPdfPageRenderer();
 
@@ -72,12 +88,35 @@ public:
     QPdfDocument* document() const;
     void setDocument(QPdfDocument *document);
 
+    int renderTimeBudget() const;
+    void setRenderTimeBudget(int msecs);
+
+    bool supersedeRequests() const;
+    void setSupersedeRequests(bool enabled);
+
+    QPdfRenderCache *renderCache() const;
+    void setRenderCache(QPdfRenderCache *cache);
+
+    int statisticsInterval() const;
+    void setStatisticsInterval(int msecs);
+
+    QPdfRenderStatistics statistics() const;
+    void resetStatistics();
+
     quint64 requestPage(int pageNumber, QSize imageSize,
-                        QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+                        QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions(),
+                        RequestPriority priority = VisiblePriority);
+    bool cancelRequest(quint64 requestId);
+    void cancelAll();
 
 Q_SIGNALS:
     void documentChanged(QPdfDocument *document);
     void renderModeChanged(RenderMode renderMode);
+    void renderTimeBudgetChanged(int renderTimeBudget);
+    void supersedeRequestsChanged(bool supersedeRequests);
+    void renderCacheChanged(QPdfRenderCache *renderCache);
+    void statisticsIntervalChanged(int statisticsInterval);
+    void statisticsUpdated(const QPdfRenderStatistics &statistics);
 
     void pageRendered(int pageNumber, QSize imageSize, const QImage &image,
                       QPdfDocumentRenderOptions options, quint64 requestId);
@@ -0,0 +1,319 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfrangeloader_p.h"
+
+#include <QDebug>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+// PDFium asks for many tiny segments, so every request is widened to this granule
+static const qint64 granuleSize = 16 * 1024;
+
+// queued requests that are closer to each other than this are merged into one
+static const qint64 coalescingDistance = 32 * 1024;
+
+static const int maximumParallelRequests = 4;
+
+// a failed request is sent again this often, after a delay that grows with every attempt
+static const int maximumRetries = 3;
+static const int retryDelay = 250; // ms
+
+static void subtractRange(QVector<QPdfRangeLoader::Range> *ranges, qint64 begin, qint64 end)
+{
+    QVector<QPdfRangeLoader::Range> result;
+    result.reserve(ranges->size() + 1);
+
+    for (const QPdfRangeLoader::Range &range : qAsConst(*ranges)) {
+        if (end <= range.begin || begin >= range.end) {
+            result.append(range);
+            continue;
+        }
+
+        if (range.begin < begin)
+            result.append({ range.begin, begin });
+        if (end < range.end)
+            result.append({ end, range.end });
+    }
+
+    *ranges = result;
+}
+
+QPdfRangeLoader::QPdfRangeLoader(QNetworkAccessManager *manager, const QNetworkRequest &request,
+                                 qint64 totalSize, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+    , m_request(request)
+    , m_totalSize(totalSize)
+    , m_startScheduled(false)
+{
+}
+
+QPdfRangeLoader::~QPdfRangeLoader()
+{
+    const auto replies = findChildren<QNetworkReply*>();
+    for (QNetworkReply *reply : replies) {
+        reply->disconnect(this);
+        reply->abort();
+    }
+}
+
+bool QPdfRangeLoader::supportsRangeRequests(const QNetworkReply *reply)
+{
+    const QString scheme = reply->url().scheme();
+
+    return reply->manager()
+        && (scheme == QLatin1String("http") || scheme == QLatin1String("https"))
+        && reply->rawHeader("Accept-Ranges").trimmed().toLower() == "bytes"
+        && reply->header(QNetworkRequest::ContentLengthHeader).isValid();
+}
+
+qint64 QPdfRangeLoader::totalSize() const
+{
+    return m_totalSize;
+}
+
+void QPdfRangeLoader::requestRange(qint64 offset, qint64 size)
+{
+    const qint64 begin = qMax(qint64(0), offset - offset % granuleSize);
+    const qint64 end = qMin(m_totalSize, ((offset + size + granuleSize - 1) / granuleSize) * granuleSize);
+    if (begin >= end)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    QVector<Range> missing = { { begin, end } };
+    subtractReceivedLocked(&missing);
+    for (const Range &range : qAsConst(m_activeRanges))
+        subtractRange(&missing, range.begin, range.end);
+    for (const Range &range : qAsConst(m_queuedRanges))
+        subtractRange(&missing, range.begin, range.end);
+
+    // Keep the order in which PDFium asked for the segments, but merge new segments into
+    // queued ones nearby, so that many small hints turn into a few larger requests.
+    for (const Range &range : qAsConst(missing)) {
+        bool merged = false;
+        for (Range &queued : m_queuedRanges) {
+            if (range.begin <= queued.end + coalescingDistance && queued.begin <= range.end + coalescingDistance) {
+                queued.begin = qMin(queued.begin, range.begin);
+                queued.end = qMax(queued.end, range.end);
+                merged = true;
+                break;
+            }
+        }
+
+        if (!merged)
+            m_queuedRanges.append(range);
+    }
+
+    if (m_queuedRanges.isEmpty() || m_startScheduled)
+        return;
+
+    // the hints can come from any thread that uses the document, the requests are sent from ours
+    m_startScheduled = true;
+    QMetaObject::invokeMethod(this, "startRequests", Qt::QueuedConnection);
+}
+
+bool QPdfRangeLoader::isAvailable(qint64 offset, qint64 size) const
+{
+    const QMutexLocker locker(&m_mutex);
+
+    return isCoveredLocked(offset, offset + size);
+}
+
+qint64 QPdfRangeLoader::read(qint64 offset, char *data, qint64 size) const
+{
+    const QMutexLocker locker(&m_mutex);
+
+    auto it = m_chunks.upperBound(offset);
+    if (it == m_chunks.constBegin())
+        return 0;
+    --it;
+
+    qint64 bytesRead = 0;
+    while (bytesRead < size && it != m_chunks.constEnd() && it.key() <= offset + bytesRead) {
+        const qint64 offsetInChunk = offset + bytesRead - it.key();
+        const qint64 length = qMin(size - bytesRead, it.value().size() - offsetInChunk);
+        if (length <= 0)
+            break;
+
+        memcpy(data + bytesRead, it.value().constData() + offsetInChunk, length);
+        bytesRead += length;
+        ++it;
+    }
+
+    return bytesRead;
+}
+
+void QPdfRangeLoader::startRequests()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_startScheduled = false;
+
+    if (!m_manager)
+        return;
+
+    while (m_activeRanges.size() < maximumParallelRequests && !m_queuedRanges.isEmpty()) {
+        const Range range = m_queuedRanges.takeFirst();
+        m_activeRanges.append(range);
+
+        QNetworkRequest request(m_request);
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(range.begin) + '-' + QByteArray::number(range.end - 1));
+
+        QNetworkReply *reply = m_manager->get(request);
+        reply->setParent(this);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, range]() { replyFinished(reply, range); });
+    }
+}
+
+void QPdfRangeLoader::replyFinished(QNetworkReply *reply, Range range)
+{
+    reply->deleteLater();
+
+    QMutexLocker locker(&m_mutex);
+
+    for (int i = 0; i < m_activeRanges.size(); ++i) {
+        if (m_activeRanges.at(i).begin == range.begin && m_activeRanges.at(i).end == range.end) {
+            m_activeRanges.remove(i);
+            break;
+        }
+    }
+
+    if (reply->error() != QNetworkReply::NoError) {
+        const int attempts = m_failedAttempts.value(range.begin) + 1;
+        if (attempts <= maximumRetries) {
+            m_failedAttempts.insert(range.begin, attempts);
+            m_queuedRanges.prepend(range);
+            locker.unlock();
+
+            QTimer::singleShot(retryDelay * attempts, this, &QPdfRangeLoader::startRequests);
+            return;
+        }
+
+        m_failedAttempts.remove(range.begin);
+        locker.unlock();
+
+        qWarning() << "QPdfDocument: Range request failed:" << reply->errorString();
+        emit errorOccurred();
+        startRequests();
+        return;
+    }
+
+    m_failedAttempts.remove(range.begin);
+
+    qint64 offset = range.begin;
+
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode == 206) {
+        // "Content-Range: bytes <first>-<last>/<total>"
+        const QByteArray contentRange = reply->rawHeader("Content-Range");
+        const int start = contentRange.indexOf(' ') + 1;
+        const int dash = contentRange.indexOf('-', start);
+        bool ok = false;
+        const qint64 first = contentRange.mid(start, dash - start).toLongLong(&ok);
+        if (ok)
+            offset = first;
+    } else {
+        // the server ignored the range and sent the complete document
+        offset = 0;
+    }
+
+    insertLocked(offset, reply->readAll());
+
+    locker.unlock();
+
+    emit dataArrived();
+
+    startRequests();
+}
+
+bool QPdfRangeLoader::isCoveredLocked(qint64 begin, qint64 end) const
+{
+    if (begin >= end)
+        return true;
+
+    auto it = m_chunks.upperBound(begin);
+    if (it == m_chunks.constBegin())
+        return false;
+    --it;
+
+    qint64 coveredEnd = it.key() + it.value().size();
+    for (++it; coveredEnd < end; ++it) {
+        if (it == m_chunks.constEnd() || it.key() != coveredEnd)
+            return false;
+
+        coveredEnd += it.value().size();
+    }
+
+    return coveredEnd >= end;
+}
+
+void QPdfRangeLoader::subtractReceivedLocked(QVector<Range> *ranges) const
+{
+    for (const Range &range : QVector<Range>(*ranges)) {
+        auto it = m_chunks.upperBound(range.begin);
+        if (it != m_chunks.constBegin())
+            --it;
+
+        for (; it != m_chunks.constEnd() && it.key() < range.end; ++it)
+            subtractRange(ranges, it.key(), it.key() + it.value().size());
+    }
+}
+
+void QPdfRangeLoader::insertLocked(qint64 offset, const QByteArray &data)
+{
+    const qint64 end = qMin(m_totalSize, offset + data.size());
+
+    QVector<Range> pieces = { { offset, end } };
+    subtractReceivedLocked(&pieces);
+
+    for (const Range &piece : qAsConst(pieces)) {
+        if (piece.begin == offset && piece.end == offset + data.size())
+            m_chunks.insert(offset, data);
+        else
+            m_chunks.insert(piece.begin, data.mid(int(piece.begin - offset), int(piece.end - piece.begin)));
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdfrangeloader_p.cpp"
@@ -0,0 +1,128 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFRANGELOADER_P_H
+#define QPDFRANGELOADER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Loads a remote document with HTTP range requests.
+//
+// Instead of downloading the document from start to end, only the segments PDFium
+// asks for through FX_DOWNLOADHINTS are fetched. Requested segments are aligned to
+// a minimum granule and merged with queued neighbours, and at most
+// maximumParallelRequests ranges are transferred at the same time. A failed request
+// is retried a few times before errorOccurred() is emitted.
+//
+// requestRange(), isAvailable() and read() can be called from any thread, the
+// network requests are always issued from the thread the loader lives in.
+class QPdfRangeLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Range
+    {
+        qint64 begin;
+        qint64 end;
+    };
+
+    QPdfRangeLoader(QNetworkAccessManager *manager, const QNetworkRequest &request,
+                    qint64 totalSize, QObject *parent = nullptr);
+    ~QPdfRangeLoader();
+
+    static bool supportsRangeRequests(const QNetworkReply *reply);
+
+    qint64 totalSize() const;
+
+    void requestRange(qint64 offset, qint64 size);
+
+    bool isAvailable(qint64 offset, qint64 size) const;
+    qint64 read(qint64 offset, char *data, qint64 size) const;
+
+Q_SIGNALS:
+    void dataArrived();
+    void errorOccurred();
+
+private Q_SLOTS:
+    void startRequests();
+
+private:
+    void replyFinished(QNetworkReply *reply, Range range);
+    bool isCoveredLocked(qint64 begin, qint64 end) const;
+    void subtractReceivedLocked(QVector<Range> *ranges) const;
+    void insertLocked(qint64 offset, const QByteArray &data);
+
+    QPointer<QNetworkAccessManager> m_manager;
+    QNetworkRequest m_request;
+    qint64 m_totalSize;
+
+    mutable QMutex m_mutex;
+    QMap<qint64, QByteArray> m_chunks;    // received data by offset, never overlapping
+    QVector<Range> m_queuedRanges;        // in the order PDFium asked for them
+    QVector<Range> m_activeRanges;
+    QHash<qint64, int> m_failedAttempts;  // begin of a range -> number of failed requests for it
+    bool m_startScheduled;
+};
+
+Q_DECLARE_TYPEINFO(QPdfRangeLoader::Range, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QPDFRANGELOADER_P_H
@@ -0,0 +1,441 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfrendercache.h"
+
+#include "qpdfdocument.h"
+
+#include <private/qobject_p.h>
+
+#include <QCache>
+#include <QMultiHash>
+#include <QMutex>
+#include <QPointer>
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+static const qint64 defaultMaximumSize = 64 * 1024 * 1024;
+
+struct QPdfRenderCacheKey
+{
+    int page;
+    QSize imageSize;
+    QPdfDocumentRenderOptions options;
+};
+
+Q_DECLARE_TYPEINFO(QPdfRenderCacheKey, Q_PRIMITIVE_TYPE);
+
+static inline bool operator==(const QPdfRenderCacheKey &lhs, const QPdfRenderCacheKey &rhs)
+{
+    return lhs.page == rhs.page && lhs.imageSize == rhs.imageSize && lhs.options == rhs.options;
+}
+
+static inline uint qHash(const QPdfRenderCacheKey &key, uint seed = 0)
+{
+    const QPdfDocumentRenderOptions options = key.options;
+    const uint optionsHash = uint(options.renderFlags()) ^ (uint(options.rotation()) << 8)
+                           ^ (uint(options.imageFormat()) << 11) ^ (uint(options.tileSize()) << 16)
+                           ^ (uint(options.tile().x()) << 20) ^ uint(options.tile().y());
+
+    return seed ^ qHash(key.page) ^ (uint(key.imageSize.width()) << 16) ^ uint(key.imageSize.height()) ^ optionsHash;
+}
+
+class QPdfRenderCachePrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(QPdfRenderCache)
+
+public:
+    QPdfRenderCachePrivate()
+        : QObjectPrivate()
+    {
+        m_cache.setMaxCost(cost(defaultMaximumSize));
+    }
+
+    // the costs are counted in KiB, so that the budget can exceed the range of an int
+    static int cost(qint64 bytes)
+    {
+        return int(qMin<qint64>((bytes + 1023) / 1024, std::numeric_limits<int>::max()));
+    }
+
+    void insertLocked(const QPdfRenderCacheKey &key, const QImage &image);
+    void pruneIndexLocked();
+
+    QPointer<QPdfDocument> m_document;
+    QMetaObject::Connection m_documentStatusConnection;
+    qint64 m_maximumSize = defaultMaximumSize;
+
+    mutable QMutex m_mutex;
+    mutable QCache<QPdfRenderCacheKey, QImage> m_cache;   // object() updates the LRU order
+
+    // The keys of the cached images by page, to find the other sizes of a page without
+    // walking the whole cache. Keys evicted by the QCache are only dropped lazily.
+    QMultiHash<int, QPdfRenderCacheKey> m_pageIndex;
+};
+
+void QPdfRenderCachePrivate::insertLocked(const QPdfRenderCacheKey &key, const QImage &image)
+{
+    if (!m_cache.contains(key))
+        m_pageIndex.insert(key.page, key);
+
+    m_cache.insert(key, new QImage(image), qMax(1, cost(image.sizeInBytes())));
+
+    if (m_pageIndex.size() > 2 * m_cache.size() + 64)
+        pruneIndexLocked();
+}
+
+void QPdfRenderCachePrivate::pruneIndexLocked()
+{
+    for (auto it = m_pageIndex.begin(); it != m_pageIndex.end(); ) {
+        if (m_cache.contains(it.value()))
+            ++it;
+        else
+            it = m_pageIndex.erase(it);
+    }
+}
+
+/*!
+    \class QPdfRenderCache
+    \since 5.11
+    \inmodule QtPdf
+
+    \brief The QPdfRenderCache class keeps rendered pages of a PDF document in memory.
+
+    A QPdfRenderCache holds the images that have been rendered from a document,
+    identified by the page, the requested image size and the render options. A
+    single cache can be shared by all the consumers of a document, for example by
+    a QPdfPageRenderer that renders for a view, a strip of thumbnails and an
+    exporter, so that a page is rendered only once for each size.
+
+    The memory used by the cache is bounded by maximumSize(); when it is exceeded,
+    the least recently used images are dropped. The cache is cleared whenever the
+    status of the document changes.
+
+    All functions of this class are thread-safe.
+
+    \sa QPdfPageRenderer::setRenderCache()
+*/
+
+/*!
+    Constructs a render cache with parent object \a parent.
+*/
+QPdfRenderCache::QPdfRenderCache(QObject *parent)
+    : QObject(*new QPdfRenderCachePrivate(), parent)
+{
+}
+
+/*!
+    Constructs a render cache for \a document with parent object \a parent.
+*/
+QPdfRenderCache::QPdfRenderCache(QPdfDocument *document, QObject *parent)
+    : QObject(*new QPdfRenderCachePrivate(), parent)
+{
+    setDocument(document);
+}
+
+/*!
+    Destroys the render cache.
+*/
+QPdfRenderCache::~QPdfRenderCache()
+{
+}
+
+/*!
+    \property QPdfRenderCache::document
+    \brief the document the cached images have been rendered from
+
+    By default, this property is \c nullptr.
+*/
+
+/*!
+    Returns the document the cached images have been rendered from.
+*/
+QPdfDocument* QPdfRenderCache::document() const
+{
+    Q_D(const QPdfRenderCache);
+
+    return d->m_document;
+}
+
+/*!
+    Sets the \a document the cached images are rendered from and clears the cache.
+*/
+void QPdfRenderCache::setDocument(QPdfDocument *document)
+{
+    Q_D(QPdfRenderCache);
+
+    if (d->m_document == document)
+        return;
+
+    disconnect(d->m_documentStatusConnection);
+
+    d->m_document = document;
+    clear();
+    emit documentChanged(d->m_document);
+
+    if (d->m_document)
+        d->m_documentStatusConnection = connect(d->m_document, &QPdfDocument::statusChanged, this, &QPdfRenderCache::clear);
+}
+
+/*!
+    \property QPdfRenderCache::maximumSize
+    \brief the number of bytes the cached images may occupy
+
+    When the images exceed this size, the least recently used ones are dropped.
+    The default is 64 MiB.
+*/
+
+/*!
+    Returns the number of bytes the cached images may occupy.
+*/
+qint64 QPdfRenderCache::maximumSize() const
+{
+    Q_D(const QPdfRenderCache);
+
+    return d->m_maximumSize;
+}
+
+/*!
+    Sets the number of bytes the cached images may occupy to \a bytes.
+*/
+void QPdfRenderCache::setMaximumSize(qint64 bytes)
+{
+    Q_D(QPdfRenderCache);
+
+    bytes = qMax<qint64>(0, bytes);
+    if (d->m_maximumSize == bytes)
+        return;
+
+    {
+        const QMutexLocker locker(&d->m_mutex);
+        d->m_maximumSize = bytes;
+        d->m_cache.setMaxCost(QPdfRenderCachePrivate::cost(bytes));
+    }
+
+    emit maximumSizeChanged(d->m_maximumSize);
+}
+
+/*!
+    Returns the number of bytes the cached images occupy, rounded up to whole KiB per image.
+*/
+qint64 QPdfRenderCache::size() const
+{
+    Q_D(const QPdfRenderCache);
+
+    const QMutexLocker locker(&d->m_mutex);
+    return qint64(d->m_cache.totalCost()) * 1024;
+}
+
+/*!
+    Returns the number of cached images.
+*/
+int QPdfRenderCache::count() const
+{
+    Q_D(const QPdfRenderCache);
+
+    const QMutexLocker locker(&d->m_mutex);
+    return d->m_cache.size();
+}
+
+/*!
+    Returns whether the image of \a page rendered in \a imageSize with \a options is cached.
+*/
+bool QPdfRenderCache::contains(int page, QSize imageSize, QPdfDocumentRenderOptions options) const
+{
+    Q_D(const QPdfRenderCache);
+
+    const QMutexLocker locker(&d->m_mutex);
+    return d->m_cache.contains({page, imageSize, options});
+}
+
+/*!
+    Returns the cached image of \a page rendered in \a imageSize with \a options,
+    or a null image if it is not cached.
+
+    \sa findNearest(), render()
+*/
+QImage QPdfRenderCache::image(int page, QSize imageSize, QPdfDocumentRenderOptions options) const
+{
+    Q_D(const QPdfRenderCache);
+
+    const QMutexLocker locker(&d->m_mutex);
+    const QImage *image = d->m_cache.object({page, imageSize, options});
+    return image ? *image : QImage();
+}
+
+/*!
+    Returns the cached image of \a page that comes closest to \a imageSize among the
+    images rendered with the same \a options, or a null image if there is none.
+
+    The smallest image that is at least as large as \a imageSize is preferred, since
+    it can be scaled down without losing detail; otherwise the largest smaller image
+    is returned. Tiles are only found in their exact size, because the area a tile
+    covers depends on the size of the page.
+
+    \sa image()
+*/
+QImage QPdfRenderCache::findNearest(int page, QSize imageSize, QPdfDocumentRenderOptions options) const
+{
+    Q_D(const QPdfRenderCache);
+
+    if (options.tileSize() != 0)
+        return image(page, imageSize, options);
+
+    const QMutexLocker locker(&d->m_mutex);
+
+    const QImage *larger = nullptr;
+    const QImage *smaller = nullptr;
+    qint64 largerArea = 0;
+    qint64 smallerArea = 0;
+
+    for (auto it = d->m_pageIndex.constFind(page); it != d->m_pageIndex.cend() && it.key() == page; ++it) {
+        const QPdfRenderCacheKey &key = it.value();
+        if (key.options != options)
+            continue;
+
+        const QImage *image = d->m_cache.object(key);
+        if (!image)
+            continue;
+
+        const qint64 area = qint64(key.imageSize.width()) * key.imageSize.height();
+        if (key.imageSize.width() >= imageSize.width() && key.imageSize.height() >= imageSize.height()) {
+            if (!larger || area < largerArea) {
+                larger = image;
+                largerArea = area;
+            }
+        } else if (!smaller || area > smallerArea) {
+            smaller = image;
+            smallerArea = area;
+        }
+    }
+
+    if (larger)
+        return *larger;
+
+    return smaller ? *smaller : QImage();
+}
+
+/*!
+    Inserts the \a image of \a page that has been rendered in \a imageSize with \a options.
+
+    For a tile, \a imageSize is the size of the whole page, as passed to QPdfDocument::render().
+    Null images are ignored.
+*/
+void QPdfRenderCache::insert(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options)
+{
+    Q_D(QPdfRenderCache);
+
+    if (image.isNull())
+        return;
+
+    const QMutexLocker locker(&d->m_mutex);
+    d->insertLocked({page, imageSize, options}, image);
+}
+
+/*!
+    Returns the image of \a page rendered in \a imageSize with \a options.
+
+    The image is taken from the cache if possible, otherwise it is rendered from
+    the document() and inserted into the cache. This function can be called
+    from any thread.
+
+    \sa QPdfDocument::render()
+*/
+QImage QPdfRenderCache::render(int page, QSize imageSize, QPdfDocumentRenderOptions options)
+{
+    Q_D(QPdfRenderCache);
+
+    const QImage cachedImage = image(page, imageSize, options);
+    if (!cachedImage.isNull())
+        return cachedImage;
+
+    const QPointer<QPdfDocument> document = d->m_document;
+    if (!document)
+        return QImage();
+
+    // the document serializes the rendering itself, the cache is not locked meanwhile
+    const QImage renderedImage = document->render(page, imageSize, options);
+    insert(page, imageSize, renderedImage, options);
+
+    return renderedImage;
+}
+
+/*!
+    Removes all cached images of \a page.
+*/
+void QPdfRenderCache::remove(int page)
+{
+    Q_D(QPdfRenderCache);
+
+    const QMutexLocker locker(&d->m_mutex);
+
+    const QList<QPdfRenderCacheKey> keys = d->m_pageIndex.values(page);
+    for (const QPdfRenderCacheKey &key : keys)
+        d->m_cache.remove(key);
+    d->m_pageIndex.remove(page);
+}
+
+/*!
+    \overload
+
+    Removes the cached image of \a page rendered in \a imageSize with \a options.
+*/
+void QPdfRenderCache::remove(int page, QSize imageSize, QPdfDocumentRenderOptions options)
+{
+    Q_D(QPdfRenderCache);
+
+    // the page index drops the key lazily
+    const QMutexLocker locker(&d->m_mutex);
+    d->m_cache.remove({page, imageSize, options});
+}
+
+/*!
+    Removes all cached images.
+*/
+void QPdfRenderCache::clear()
+{
+    Q_D(QPdfRenderCache);
+
+    const QMutexLocker locker(&d->m_mutex);
+
+    d->m_cache.clear();
+    d->m_pageIndex.clear();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdfrendercache.cpp"
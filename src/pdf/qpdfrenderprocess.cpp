@@ -0,0 +1,414 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfrenderprocess_p.h"
+
+#include <QAtomicInteger>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFileInfo>
+#include <QLibraryInfo>
+#include <QMutex>
+#include <QProcess>
+#include <QSharedMemory>
+#include <QTimer>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+// A request is retried once in a fresh helper, if it fails a second time the page
+// is considered broken and delivered as an empty image.
+static const int maximumAttempts = 2;
+
+// A helper that has not answered a request after this many milliseconds is considered
+// hung, it is killed and the request is handled like one that crashed the helper.
+static const int defaultRequestTimeout = 30000;
+
+// The number of unused segments that are kept for the next requests
+static const int maximumFreeSegments = 8;
+
+// The shared memory segments that are not in use. The images handed out by the pool point
+// into their segments and give them back once the last copy is gone, which may happen in
+// another thread or after the pool has been destroyed.
+class QPdfRenderSegmentPool
+{
+public:
+    ~QPdfRenderSegmentPool()
+    {
+        qDeleteAll(m_segments);
+    }
+
+    // Returns the smallest free segment of at least size bytes, or nullptr if there is none.
+    QSharedMemory *take(int size)
+    {
+        const QMutexLocker locker(&m_mutex);
+
+        int best = -1;
+        for (int i = 0; i < m_segments.size(); ++i) {
+            const int segmentSize = m_segments.at(i)->size();
+            if (segmentSize >= size && (best < 0 || segmentSize < m_segments.at(best)->size()))
+                best = i;
+        }
+
+        return best < 0 ? nullptr : m_segments.takeAt(best);
+    }
+
+    // Keeps the segment for later requests; once there are too many, the smallest one goes.
+    void give(QSharedMemory *segment)
+    {
+        const QMutexLocker locker(&m_mutex);
+
+        m_segments.append(segment);
+        if (m_segments.size() <= maximumFreeSegments)
+            return;
+
+        const auto smallest = std::min_element(m_segments.begin(), m_segments.end(),
+                                               [](QSharedMemory *lhs, QSharedMemory *rhs) { return lhs->size() < rhs->size(); });
+        delete *smallest;
+        m_segments.erase(smallest);
+    }
+
+private:
+    QMutex m_mutex;
+    QVector<QSharedMemory *> m_segments;
+};
+
+struct QPdfRenderSegment
+{
+    QSharedPointer<QPdfRenderSegmentPool> pool;
+    QSharedMemory *sharedMemory;
+};
+
+// the cleanup function of the images that point into a segment
+static void returnSegment(void *info)
+{
+    QPdfRenderSegment *segment = static_cast<QPdfRenderSegment *>(info);
+    segment->pool->give(segment->sharedMemory);
+    delete segment;
+}
+
+QPdfRenderProcessPool::QPdfRenderProcessPool(int processCount, QObject *parent)
+    : QObject(parent)
+    , m_executable(helperExecutable())
+    , m_requestTimeout(defaultRequestTimeout)
+    , m_segments(new QPdfRenderSegmentPool)
+{
+    m_workers.resize(qMax(1, processCount));
+
+    for (int index = 0; index < m_workers.size(); ++index) {
+        QTimer *timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, [this, index]() { processTimedOut(index); });
+        m_workers[index].timer = timer;
+    }
+}
+
+QPdfRenderProcessPool::~QPdfRenderProcessPool()
+{
+    for (Worker &worker : m_workers) {
+        if (worker.process) {
+            worker.process->disconnect(this);
+
+            // the helper quits on its own once its stdin is closed
+            worker.process->closeWriteChannel();
+            if (!worker.process->waitForFinished(1000))
+                worker.process->kill();
+        }
+
+        if (worker.busy)
+            releaseSegment(&worker.job);
+    }
+}
+
+QString QPdfRenderProcessPool::helperExecutable()
+{
+    const QByteArray fromEnvironment = qgetenv("QTPDF_RENDER_PROCESS_PATH");
+    if (!fromEnvironment.isEmpty())
+        return QString::fromLocal8Bit(fromEnvironment);
+
+#ifdef Q_OS_WIN
+    const QString name = QStringLiteral("QtPdfRenderProcess.exe");
+#else
+    const QString name = QStringLiteral("QtPdfRenderProcess");
+#endif
+
+    // the helper is installed with Qt's other helpers; before the module has been installed,
+    // e.g. for its tests, QTPDF_RENDER_PROCESS_PATH points at the one in the build tree
+    const QStringList directories = { QLibraryInfo::location(QLibraryInfo::LibraryExecutablesPath),
+                                      QCoreApplication::applicationDirPath() };
+    for (const QString &directory : directories) {
+        const QFileInfo candidate(directory + QLatin1Char('/') + name);
+        if (candidate.isExecutable())
+            return candidate.absoluteFilePath();
+    }
+
+    return QString();
+}
+
+bool QPdfRenderProcessPool::canRender(const QString &fileName) const
+{
+    return !m_executable.isEmpty() && !fileName.isEmpty();
+}
+
+// the size of the image a request produces, which is only the tile for tile requests
+static QSize outputSize(const QPdfRenderProcessRequest &request)
+{
+    if (request.options.tileSize() <= 0)
+        return request.imageSize;
+
+    return (request.options.tileRect() & QRect(QPoint(0, 0), request.imageSize)).size();
+}
+
+void QPdfRenderProcessPool::requestPage(quint64 requestId, const QString &fileName, const QByteArray &password,
+                                        int pageNumber, QSize imageSize, QPdfDocumentRenderOptions options)
+{
+    Job job;
+    job.request.id = requestId;
+    job.request.fileName = fileName;
+    job.request.password = password;
+    job.request.pageNumber = pageNumber;
+    job.request.imageSize = imageSize;
+    job.request.options = options;
+
+    const QSize size = outputSize(job.request);
+    if (size.isEmpty()) {
+        emit pageRendered(pageNumber, imageSize, QImage(), options, requestId);
+        return;
+    }
+
+    // scan lines are 32-bit aligned, like those of a QImage
+    const int bitsPerPixel = QImage::toPixelFormat(options.imageFormat()).bitsPerPixel();
+    job.request.bytesPerLine = ((size.width() * bitsPerPixel + 31) >> 5) << 2;
+
+    m_jobs.enqueue(job);
+    dispatch();
+}
+
+void QPdfRenderProcessPool::startProcess(int index)
+{
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, index, process]() {
+        if (m_workers.at(index).process == process)
+            processOutput(index);
+    });
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, index, process]() {
+        if (m_workers.at(index).process == process)
+            processFinished(index);
+    });
+
+    // the helper is started in the background, its jobs stay queued until it is running
+    connect(process, &QProcess::started, this, [this, index, process]() {
+        if (m_workers.at(index).process == process)
+            dispatch();
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, index, process](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart || m_workers.at(index).process != process)
+            return;
+
+        qWarning() << "QPdfPageRenderer: Could not start render process" << m_executable << process->errorString();
+        m_executable.clear();
+        processFinished(index);
+    });
+
+    m_workers[index].process = process;
+
+    process->start(m_executable, QStringList(), QIODevice::ReadWrite);
+}
+
+// Hands a segment that can take the image of the job to it, a free one if possible.
+bool QPdfRenderProcessPool::acquireSegment(Job *job)
+{
+    static QAtomicInteger<quint64> segmentCounter;
+
+    const int size = job->request.bytesPerLine * outputSize(job->request).height();
+
+    job->sharedMemory = m_segments->take(size);
+    if (!job->sharedMemory) {
+        const QString key = QStringLiteral("qtpdf-render-%1-%2")
+                .arg(QCoreApplication::applicationPid()).arg(segmentCounter.fetchAndAddRelaxed(1));
+        job->sharedMemory = new QSharedMemory(key);
+        if (!job->sharedMemory->create(size)) {
+            qWarning() << "QPdfPageRenderer: Could not allocate shared memory for page"
+                       << job->request.pageNumber << job->sharedMemory->errorString();
+            delete job->sharedMemory;
+            job->sharedMemory = nullptr;
+            return false;
+        }
+    }
+
+    job->request.sharedMemoryKey = job->sharedMemory->key();
+    return true;
+}
+
+void QPdfRenderProcessPool::releaseSegment(Job *job)
+{
+    if (job->sharedMemory)
+        m_segments->give(job->sharedMemory);
+    job->sharedMemory = nullptr;
+}
+
+void QPdfRenderProcessPool::dispatch()
+{
+    for (int index = 0; index < m_workers.size() && !m_jobs.isEmpty(); ++index) {
+        if (m_workers.at(index).busy)
+            continue;
+
+        if (m_executable.isEmpty()) {
+            // the helper cannot be started at all, fail everything that is still queued
+            while (!m_jobs.isEmpty()) {
+                const Job job = m_jobs.dequeue();
+                emit pageRendered(job.request.pageNumber, job.request.imageSize, QImage(),
+                                  job.request.options, job.request.id);
+            }
+            return;
+        }
+
+        if (!m_workers.at(index).process) {
+            startProcess(index);
+            continue;
+        }
+
+        if (m_workers.at(index).process->state() != QProcess::Running)
+            continue;
+
+        Worker &worker = m_workers[index];
+        worker.job = m_jobs.dequeue();
+        worker.job.attempts++;
+        worker.busy = true;
+
+        if (!acquireSegment(&worker.job)) {
+            finishJob(index, false);
+            return;
+        }
+
+        QByteArray message;
+        QDataStream stream(&message, QIODevice::WriteOnly);
+        stream << worker.job.request;
+        worker.process->write(message);
+
+        if (m_requestTimeout >= 0)
+            worker.timer->start(m_requestTimeout);
+    }
+}
+
+void QPdfRenderProcessPool::processOutput(int index)
+{
+    QDataStream stream(m_workers.at(index).process);
+
+    while (m_workers.at(index).busy) {
+        stream.startTransaction();
+
+        QPdfRenderProcessReply reply;
+        stream >> reply;
+
+        if (!stream.commitTransaction())
+            return;
+
+        if (reply.id == m_workers.at(index).job.request.id)
+            finishJob(index, reply.ok);
+    }
+}
+
+void QPdfRenderProcessPool::processFinished(int index)
+{
+    Worker &worker = m_workers[index];
+
+    worker.timer->stop();
+    worker.process->disconnect(this);
+    worker.process->deleteLater();
+    worker.process = nullptr;
+
+    if (worker.busy) {
+        if (worker.job.attempts < maximumAttempts && !m_executable.isEmpty()) {
+            // transparently retry the request in a fresh helper process
+            releaseSegment(&worker.job);
+            m_jobs.prepend(worker.job);
+            worker.busy = false;
+            worker.job = Job();
+        } else {
+            finishJob(index, false);
+            return;
+        }
+    }
+
+    dispatch();
+}
+
+void QPdfRenderProcessPool::processTimedOut(int index)
+{
+    Worker &worker = m_workers[index];
+    if (!worker.busy || !worker.process)
+        return;
+
+    qWarning() << "QPdfPageRenderer: Render process did not answer within" << m_requestTimeout
+               << "ms, restarting it";
+
+    // the request is retried or failed once the process has finished
+    worker.process->kill();
+}
+
+void QPdfRenderProcessPool::finishJob(int index, bool ok)
+{
+    Worker &worker = m_workers[index];
+    worker.timer->stop();
+
+    Job job = worker.job;
+    worker.job = Job();
+    worker.busy = false;
+
+    QImage image;
+    if (ok) {
+        // the image returns the segment to the pool once the last copy of it is gone
+        const QSize size = outputSize(job.request);
+        image = QImage(static_cast<uchar*>(job.sharedMemory->data()), size.width(), size.height(),
+                       job.request.bytesPerLine, job.request.options.imageFormat(),
+                       returnSegment, new QPdfRenderSegment{ m_segments, job.sharedMemory });
+    } else {
+        releaseSegment(&job);
+    }
+
+    emit pageRendered(job.request.pageNumber, job.request.imageSize, image, job.request.options, job.request.id);
+
+    dispatch();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdfrenderprocess_p.cpp"
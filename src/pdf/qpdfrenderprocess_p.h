@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFRENDERPROCESS_P_H
+#define QPDFRENDERPROCESS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtpdfglobal.h"
+
+#include <QDataStream>
+#include <QImage>
+#include <QObject>
+#include <QPdfDocumentRenderOptions>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QSize>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+
+class QPdfRenderSegmentPool;
+class QProcess;
+class QSharedMemory;
+class QTimer;
+
+// The messages exchanged between QPdfRenderProcessPool and the QtPdfRenderProcess
+// helper over the helper's stdin/stdout. The pixel data itself does not go through
+// the pipe: the pool hands a shared memory segment to each request, the helper renders
+// into it and the pool hands it out as QImage without copying. The segment returns to
+// the pool once the last copy of the image is gone.
+struct QPdfRenderProcessRequest
+{
+    quint64 id = 0;
+    QString fileName;
+    QByteArray password;
+    int pageNumber = 0;
+    QSize imageSize;
+    QPdfDocumentRenderOptions options;
+    QString sharedMemoryKey;
+    int bytesPerLine = 0;
+};
+
+struct QPdfRenderProcessReply
+{
+    quint64 id = 0;
+    bool ok = false;
+};
+
+inline QDataStream &operator<<(QDataStream &stream, const QPdfRenderProcessRequest &request)
+{
+    return stream << request.id << request.fileName << request.password << qint32(request.pageNumber)
+                  << request.imageSize << request.options << request.sharedMemoryKey << qint32(request.bytesPerLine);
+}
+
+inline QDataStream &operator>>(QDataStream &stream, QPdfRenderProcessRequest &request)
+{
+    qint32 pageNumber;
+    qint32 bytesPerLine;
+    stream >> request.id >> request.fileName >> request.password >> pageNumber
+           >> request.imageSize >> request.options >> request.sharedMemoryKey >> bytesPerLine;
+    request.pageNumber = pageNumber;
+    request.bytesPerLine = bytesPerLine;
+    return stream;
+}
+
+inline QDataStream &operator<<(QDataStream &stream, const QPdfRenderProcessReply &reply)
+{
+    return stream << reply.id << reply.ok;
+}
+
+inline QDataStream &operator>>(QDataStream &stream, QPdfRenderProcessReply &reply)
+{
+    return stream >> reply.id >> reply.ok;
+}
+
+class Q_AUTOTEST_EXPORT QPdfRenderProcessPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QPdfRenderProcessPool(int processCount, QObject *parent = nullptr);
+    ~QPdfRenderProcessPool();
+
+    static QString helperExecutable();
+
+    int processCount() const { return m_workers.size(); }
+    bool canRender(const QString &fileName) const;
+
+    int requestTimeout() const { return m_requestTimeout; }
+    void setRequestTimeout(int msecs) { m_requestTimeout = msecs; }
+
+    void requestPage(quint64 requestId, const QString &fileName, const QByteArray &password,
+                     int pageNumber, QSize imageSize, QPdfDocumentRenderOptions options);
+
+Q_SIGNALS:
+    void pageRendered(int pageNumber, QSize imageSize, const QImage &image,
+                      QPdfDocumentRenderOptions options, quint64 requestId);
+
+private:
+    struct Job
+    {
+        QPdfRenderProcessRequest request;
+        QSharedMemory *sharedMemory = nullptr;  // only while the job is being rendered
+        int attempts = 0;
+    };
+
+    struct Worker
+    {
+        QProcess *process = nullptr;
+        QTimer *timer = nullptr;                // fires when the helper takes too long
+        Job job;
+        bool busy = false;
+    };
+
+    void startProcess(int index);
+    bool acquireSegment(Job *job);
+    void releaseSegment(Job *job);
+    void dispatch();
+    void processOutput(int index);
+    void processFinished(int index);
+    void processTimedOut(int index);
+    void finishJob(int index, bool ok);
+
+    QVector<Worker> m_workers;
+    QQueue<Job> m_jobs;
+    QString m_executable;
+    int m_requestTimeout;
+    QSharedPointer<QPdfRenderSegmentPool> m_segments;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFRENDERPROCESS_P_H
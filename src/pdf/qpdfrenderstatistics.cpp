@@ -0,0 +1,265 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfrenderstatistics.h"
+#include "qpdfrenderstatistics_p.h"
+
+#include <QDeadlineTimer>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+QPdfRenderStatisticsPrivate::QPdfRenderStatisticsPrivate()
+    : queuedRequests(0)
+    , pendingRequests(0)
+    , requestCount(0)
+    , completedRequests(0)
+    , cancelledRequests(0)
+    , cacheHits(0)
+    , startTime(QDeadlineTimer::current().deadlineNSecs())
+    , endTime(startTime)
+{
+    std::fill(totalTimes, totalTimes + 3, 0);
+    std::fill(counts, counts + 3, 0);
+    std::fill(&histograms[0][0], &histograms[0][0] + 3 * HistogramSize, 0);
+}
+
+int QPdfRenderStatisticsPrivate::bucket(qint64 nsecs)
+{
+    quint64 usecs = quint64(qMax<qint64>(0, nsecs)) / 1000;
+
+    int bucket = 0;
+    while (usecs && bucket < HistogramSize - 1) {
+        usecs >>= 1;
+        ++bucket;
+    }
+
+    return bucket;
+}
+
+void QPdfRenderStatisticsPrivate::record(QPdfRenderStatistics::Stage stage, qint64 nsecs)
+{
+    totalTimes[stage] += nsecs;
+    ++counts[stage];
+    ++histograms[stage][bucket(nsecs)];
+}
+
+/*!
+    \class QPdfRenderStatistics
+    \since 5.11
+    \inmodule QtPdf
+
+    \brief The QPdfRenderStatistics class describes how a QPdfPageRenderer has performed.
+
+    A QPdfRenderStatistics object is a snapshot of the counters a QPdfPageRenderer
+    keeps about its requests: the number of requests that are queued or being
+    rendered, how many have been completed, cancelled or answered from the render
+    cache, and how long each request has spent in each Stage.
+
+    The times are collected in histograms with buckets of powers of two
+    microseconds, which cost a few additions per request, so the statistics can
+    stay enabled in production.
+
+    \sa QPdfPageRenderer::statistics(), QPdfPageRenderer::statisticsUpdated()
+*/
+
+/*!
+    \enum QPdfRenderStatistics::Stage
+
+    This enum describes the stages a request passes through.
+
+    \value QueueWait The time from requestPage() until the request is handed to a worker.
+    \value Render The time the worker takes to render the page. In the
+           QPdfPageRenderer::MultiProcessRenderMode this includes the transfer
+           of the image from the helper process.
+    \value Delivery The time from the end of the rendering until the result has
+           reached the thread of the renderer. For requests that are answered from
+           the render cache, this is the only stage that is recorded.
+*/
+
+/*!
+    Constructs empty statistics.
+*/
+QPdfRenderStatistics::QPdfRenderStatistics()
+    : d(new QPdfRenderStatisticsPrivate)
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QPdfRenderStatistics::QPdfRenderStatistics(const QPdfRenderStatistics &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Assigns \a other to these statistics.
+*/
+QPdfRenderStatistics &QPdfRenderStatistics::operator=(const QPdfRenderStatistics &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn QPdfRenderStatistics::QPdfRenderStatistics(QPdfRenderStatistics &&other)
+
+    Move-constructs the statistics from \a other. The moved-from object can only
+    be destroyed or assigned to.
+*/
+
+/*!
+    \fn QPdfRenderStatistics &QPdfRenderStatistics::operator=(QPdfRenderStatistics &&other)
+
+    Move-assigns \a other to these statistics.
+*/
+
+/*!
+    \fn void QPdfRenderStatistics::swap(QPdfRenderStatistics &other)
+
+    Swaps these statistics with \a other. This operation is very fast and never fails.
+*/
+
+/*!
+    Destroys the statistics.
+*/
+QPdfRenderStatistics::~QPdfRenderStatistics()
+{
+}
+
+/*!
+    Returns the number of requests that were waiting in the queue.
+*/
+int QPdfRenderStatistics::queuedRequests() const
+{
+    return d->queuedRequests;
+}
+
+/*!
+    Returns the number of requests that were being rendered.
+*/
+int QPdfRenderStatistics::pendingRequests() const
+{
+    return d->pendingRequests;
+}
+
+/*!
+    Returns the number of requests that have been made.
+
+    Requests that were merged with an identical queued or pending request are not counted.
+*/
+quint64 QPdfRenderStatistics::requestCount() const
+{
+    return d->requestCount;
+}
+
+/*!
+    Returns the number of requests whose result has been delivered through
+    QPdfPageRenderer::pageRendered().
+*/
+quint64 QPdfRenderStatistics::completedRequests() const
+{
+    return d->completedRequests;
+}
+
+/*!
+    Returns the number of requests that have been cancelled or superseded.
+*/
+quint64 QPdfRenderStatistics::cancelledRequests() const
+{
+    return d->cancelledRequests;
+}
+
+/*!
+    Returns the number of requests that have been answered from the render cache.
+
+    \sa QPdfPageRenderer::renderCache()
+*/
+quint64 QPdfRenderStatistics::cacheHits() const
+{
+    return d->cacheHits;
+}
+
+/*!
+    Returns the time in milliseconds over which the statistics have been collected.
+*/
+qint64 QPdfRenderStatistics::elapsedTime() const
+{
+    return (d->endTime - d->startTime) / (1000 * 1000);
+}
+
+/*!
+    Returns the number of completed requests per second over elapsedTime().
+*/
+qreal QPdfRenderStatistics::throughput() const
+{
+    const qint64 nsecs = d->endTime - d->startTime;
+    return nsecs > 0 ? qreal(d->completedRequests) * 1e9 / nsecs : 0;
+}
+
+/*!
+    Returns the time in microseconds all requests together have spent in \a stage.
+*/
+qint64 QPdfRenderStatistics::totalTime(Stage stage) const
+{
+    return d->totalTimes[stage] / 1000;
+}
+
+/*!
+    Returns the time in microseconds a request has spent in \a stage on average.
+*/
+qint64 QPdfRenderStatistics::averageTime(Stage stage) const
+{
+    return d->counts[stage] ? qint64(d->totalTimes[stage] / 1000 / qint64(d->counts[stage])) : 0;
+}
+
+/*!
+    Returns the histogram of the times the requests have spent in \a stage.
+
+    Entry 0 counts the requests that took less than one microsecond, entry \c i
+    those that took from 2^(i-1) up to 2^i microseconds. The last entry also
+    counts all longer times.
+*/
+QVector<quint64> QPdfRenderStatistics::histogram(Stage stage) const
+{
+    QVector<quint64> histogram(QPdfRenderStatisticsPrivate::HistogramSize);
+    std::copy(d->histograms[stage], d->histograms[stage] + QPdfRenderStatisticsPrivate::HistogramSize, histogram.begin());
+    return histogram;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFRENDERSTATISTICS_H
+#define QPDFRENDERSTATISTICS_H
+
+#include "qtpdfglobal.h"
+
+#include <QMetaType>
+#include <QSharedDataPointer>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+
+class QPdfRenderStatisticsPrivate;
+
+class Q_PDF_EXPORT QPdfRenderStatistics
+{
+public:
+    enum Stage
+    {
+        QueueWait,
+        Render,
+        Delivery
+    };
+
+    QPdfRenderStatistics();
+    QPdfRenderStatistics(const QPdfRenderStatistics &other);
+    QPdfRenderStatistics &operator=(const QPdfRenderStatistics &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    QPdfRenderStatistics(QPdfRenderStatistics &&other) Q_DECL_NOTHROW : d(std::move(other.d)) {}
+    QPdfRenderStatistics &operator=(QPdfRenderStatistics &&other) Q_DECL_NOTHROW { swap(other); return *this; }
+#endif
+    ~QPdfRenderStatistics();
+
+    void swap(QPdfRenderStatistics &other) Q_DECL_NOTHROW { qSwap(d, other.d); }
+
+    int queuedRequests() const;
+    int pendingRequests() const;
+
+    quint64 requestCount() const;
+    quint64 completedRequests() const;
+    quint64 cancelledRequests() const;
+    quint64 cacheHits() const;
+
+    qint64 elapsedTime() const;
+    qreal throughput() const;
+
+    qint64 totalTime(Stage stage) const;
+    qint64 averageTime(Stage stage) const;
+    QVector<quint64> histogram(Stage stage) const;
+
+private:
+    friend class QPdfPageRendererPrivate;
+
+    QSharedDataPointer<QPdfRenderStatisticsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QPdfRenderStatistics)
+
+QT_END_NAMESPACE
+
+Q_DECLARE_METATYPE(QPdfRenderStatistics)
+
+#endif
@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFRENDERSTATISTICS_P_H
+#define QPDFRENDERSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qpdfrenderstatistics.h"
+
+#include <QSharedData>
+
+QT_BEGIN_NAMESPACE
+
+// The counters behind QPdfRenderStatistics. QPdfPageRendererPrivate updates them from the
+// thread the renderer lives in, so recording a request is a few additions without any locking.
+class QPdfRenderStatisticsPrivate : public QSharedData
+{
+public:
+    // bucket 0 counts durations below 1 µs, bucket i those from 2^(i-1) to 2^i µs
+    enum { HistogramSize = 32 };
+
+    QPdfRenderStatisticsPrivate();
+
+    static int bucket(qint64 nsecs);
+    void record(QPdfRenderStatistics::Stage stage, qint64 nsecs);
+
+    int queuedRequests;
+    int pendingRequests;
+
+    quint64 requestCount;
+    quint64 completedRequests;
+    quint64 cancelledRequests;
+    quint64 cacheHits;
+
+    qint64 startTime;       // QDeadlineTimer::current() in ns when the counting started
+    qint64 endTime;         // the same when the snapshot was taken
+
+    qint64 totalTimes[3];   // ns, indexed by QPdfRenderStatistics::Stage
+    quint64 counts[3];
+    quint64 histograms[3][HistogramSize];
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFRENDERSTATISTICS_P_H
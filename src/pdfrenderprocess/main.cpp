@@ -0,0 +1,126 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtPdf/private/qpdfrenderprocess_p.h>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QPdfDocument>
+#include <QSharedMemory>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// Helper process of QPdfPageRenderer::MultiProcessRenderMode.
+//
+// Reads QPdfRenderProcessRequest messages from stdin, renders the requested page into
+// the shared memory segment named in the request and answers with a QPdfRenderProcessReply
+// on stdout. A crash while rendering only takes down this process, the parent restarts it.
+// The process quits once its stdin is closed.
+
+static bool renderRequest(QPdfDocument *document, const QPdfRenderProcessRequest &request)
+{
+    if (document->status() != QPdfDocument::Ready || request.pageNumber < 0
+        || request.pageNumber >= document->pageCount())
+        return false;
+
+    // the segments are passed around between the requests, and freed by the parent at any
+    // time, so each one is only attached while it is rendered into
+    QSharedMemory segment(request.sharedMemoryKey);
+    if (!segment.attach())
+        return false;
+
+    // tile requests only transfer the tile
+    const int height = request.options.tileSize() > 0
+            ? (request.options.tileRect() & QRect(QPoint(0, 0), request.imageSize)).height()
+            : request.imageSize.height();
+    if (segment.size() < request.bytesPerLine * height)
+        return false;
+
+    return document->render(request.pageNumber, static_cast<uchar*>(segment.data()), request.imageSize,
+                            request.bytesPerLine, request.options.imageFormat(), request.options);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+#ifdef Q_OS_WIN
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    QFile input;
+    QFile output;
+    if (!input.open(stdin, QIODevice::ReadOnly) || !output.open(stdout, QIODevice::WriteOnly))
+        return 1;
+
+    QDataStream in(&input);
+    QDataStream out(&output);
+
+    QPdfDocument document;
+    QString loadedFileName;
+    QByteArray loadedPassword;
+
+    forever {
+        QPdfRenderProcessRequest request;
+        in >> request;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        if (request.fileName != loadedFileName || request.password != loadedPassword) {
+            // closing clears the password, so it has to happen before setting the new one
+            document.close();
+            document.setPassword(QString::fromUtf8(request.password));
+            document.load(request.fileName);
+            loadedFileName = request.fileName;
+            loadedPassword = request.password;
+        }
+
+        QPdfRenderProcessReply reply;
+        reply.id = request.id;
+        reply.ok = renderRequest(&document, request);
+
+        out << reply;
+        output.flush();
+    }
+
+    return 0;
+}
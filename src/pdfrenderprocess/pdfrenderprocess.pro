@@ -0,0 +1,13 @@
+TARGET = QtPdfRenderProcess
+TEMPLATE = app
+QT = core gui pdf pdf-private
+CONFIG -= app_bundle
+CONFIG += c++11
+
+load(qt_build_paths)
+DESTDIR = $$MODULE_BASE_OUTDIR/libexec
+
+SOURCES += main.cpp
+
+target.path = $$[QT_INSTALL_LIBEXECS]
+INSTALLS += target
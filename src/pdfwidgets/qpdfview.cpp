@@ -45,9 +45,13 @@
 #include <QScreen>
 #include <QScrollBar>
 #include <QScroller>
+#include <QTimer>
 
 #include <QPdfDocumentRenderOptions>
 
+#include <algorithm>
+#include <limits>
+
 QT_BEGIN_NAMESPACE
 
 QPdfViewPrivate::QPdfViewPrivate()
@@ -61,10 +65,19 @@ QPdfViewPrivate::QPdfViewPrivate()
     , m_pageSpacing(3)
     , m_documentMargins(6, 6, 6, 6)
     , m_blockPageScrolling(false)
-    , m_pageCacheLimit(20)
+    , m_layoutUpdatePending(false)
+    , m_prefetchPages(1)
+    , m_prefetchPixels(0)
+    , m_lastScrollTime(0)
+    , m_scrollVelocity(0.0)
+    , m_scrollDirection(0)
+    , m_defaultRenderCache(nullptr)
+    , m_evictionCandidatesValid(false)
     , m_documentOptions()
     , m_screenResolution(QGuiApplication::primaryScreen()->logicalDotsPerInch() / 72.0)
 {
+    // the pages are drawn on a white background anyway, so opaque images can be blitted directly
+    m_documentOptions.setImageFormat(QImage::Format_RGB32);
 }
 
 void QPdfViewPrivate::init()
@@ -74,14 +87,47 @@ void QPdfViewPrivate::init()
     m_pageNavigation = new QPdfPageNavigation(q);
     m_pageRenderer = new QPdfPageRenderer(q);
     m_pageRenderer->setRenderMode(QPdfPageRenderer::MultiThreadedRenderMode);
+    m_pageRenderer->setSupersedeRequests(true);
+
+    // room for the tiles of a few screens full of pages
+    const QSize screenSize = QGuiApplication::primaryScreen()->size() * QGuiApplication::primaryScreen()->devicePixelRatio();
+    m_defaultRenderCache = new QPdfRenderCache(q);
+    m_defaultRenderCache->setMaximumSize(qMax<qint64>(64 * 1024 * 1024, 4 * 4 * qint64(screenSize.width()) * screenSize.height()));
+    m_pageRenderer->setRenderCache(m_defaultRenderCache);
+
+    m_scrollTimer.start();
 }
 
 void QPdfViewPrivate::documentStatusChanged()
 {
+    m_cachedTiles.clear();
+    m_failedTiles.clear();
+    m_evictionCandidatesValid = false;
+    m_placeholders.clear();
     updateDocumentLayout();
     invalidatePageCache();
 }
 
+void QPdfViewPrivate::pageAvailable(int page)
+{
+    Q_Q(QPdfView);
+
+    Q_UNUSED(page)
+
+    // the real size of the page is known now, pages arrive in bursts so update the layout only once
+    if (m_layoutUpdatePending)
+        return;
+
+    m_layoutUpdatePending = true;
+    QTimer::singleShot(0, q, [this]() {
+        Q_Q(QPdfView);
+
+        m_layoutUpdatePending = false;
+        updateDocumentLayout();
+        q->viewport()->update();
+    });
+}
+
 void QPdfViewPrivate::currentPageChanged(int currentPage)
 {
     Q_Q(QPdfView);
@@ -113,8 +159,13 @@ void QPdfViewPrivate::setViewport(QRect viewport)
         return;
 
     const QSize oldSize = m_viewport.size();
+    const int dy = viewport.y() - m_viewport.y();
 
     m_viewport = viewport;
+    m_evictionCandidatesValid = false;
+
+    if (oldSize == m_viewport.size())
+        updateScrollVelocity(dy);
 
     if (oldSize != m_viewport.size()) {
         updateDocumentLayout();
@@ -131,13 +182,9 @@ void QPdfViewPrivate::setViewport(QRect viewport)
         const QRect currentPageLine(m_viewport.x(), m_viewport.y() + m_viewport.height() * 0.4, m_viewport.width(), 2);
 
         int currentPage = 0;
-        for (auto it = m_documentLayout.pageGeometries.cbegin(); it != m_documentLayout.pageGeometries.cend(); ++it) {
-            const QRect pageGeometry = it.value();
-            if (pageGeometry.intersects(currentPageLine)) {
-                currentPage = it.key();
-                break;
-            }
-        }
+        const int page = m_documentLayout.pageAt(currentPageLine.top());
+        if (m_documentLayout.pageGeometry(page).intersects(currentPageLine))
+            currentPage = page;
 
         if (currentPage != m_pageNavigation->currentPage()) {
             m_blockPageScrolling = true;
@@ -145,6 +192,28 @@ void QPdfViewPrivate::setViewport(QRect viewport)
             m_blockPageScrolling = false;
         }
     }
+
+    cancelInvisibleRequests();
+}
+
+void QPdfViewPrivate::updateScrollVelocity(int dy)
+{
+    if (dy == 0)
+        return;
+
+    const qint64 now = m_scrollTimer.elapsed();
+    const qint64 elapsed = now - m_lastScrollTime;
+    const qreal velocity = qreal(qAbs(dy)) / qMax<qint64>(elapsed, 1);
+    const int direction = (dy > 0 ? 1 : -1);
+
+    // smooth out the jitter of wheel and touch events, but follow a change of direction at once
+    if (elapsed > ScrollIdleTime || direction != m_scrollDirection)
+        m_scrollVelocity = velocity;
+    else
+        m_scrollVelocity = (m_scrollVelocity + velocity) / 2;
+
+    m_scrollDirection = direction;
+    m_lastScrollTime = now;
 }
 
 void QPdfViewPrivate::updateScrollBars()
@@ -160,23 +229,34 @@ void QPdfViewPrivate::updateScrollBars()
     q->verticalScrollBar()->setPageStep(p.height());
 }
 
-void QPdfViewPrivate::pageRendered(int pageNumber, QSize imageSize, const QImage &image, quint64 requestId)
+void QPdfViewPrivate::pageRendered(int pageNumber, QSize imageSize, const QImage &image,
+                                   QPdfDocumentRenderOptions options, quint64 requestId)
 {
     Q_Q(QPdfView);
 
-    Q_UNUSED(imageSize)
-    Q_UNUSED(requestId)
+    const QPdfViewTile tile = { pageNumber, options.tile() };
 
-    if (!m_cachedPagesLRU.contains(pageNumber)) {
-        if (m_cachedPagesLRU.length() > m_pageCacheLimit)
-            m_pageCache.remove(m_cachedPagesLRU.takeFirst());
+    if (m_renderRequests.value(tile) == requestId)
+        m_renderRequests.remove(tile);
 
-        m_cachedPagesLRU.append(pageNumber);
+    if (image.isNull()) {
+        m_failedTiles.insert(tile, { imageSize, options });
+        return;
     }
+    m_failedTiles.remove(tile);
 
-    m_pageCache.insert(pageNumber, image);
+    // the renderer only fills a cache of its own document
+    if (renderCache() != m_pageRenderer->renderCache())
+        renderCache()->insert(pageNumber, imageSize, image, options);
 
-    q->viewport()->update();
+    m_cachedTiles.insert(tile, { imageSize, options });
+    evictTiles();
+
+    // tiles of a layout that has changed in the meantime are not drawn
+    if (imageSize != m_documentLayout.pageGeometry(pageNumber).size())
+        return;
+
+    q->viewport()->update(tileGeometry(tile).translated(-m_viewport.topLeft()));
 }
 
 void QPdfViewPrivate::invalidateDocumentLayout()
@@ -189,10 +269,289 @@ void QPdfViewPrivate::invalidatePageCache()
 {
     Q_Q(QPdfView);
 
-    m_pageCache.clear();
+    // the cache is keyed by the size and the options, so it never serves outdated tiles;
+    // the pages are requested again in their new size once they are painted, until then
+    // the tiles of their previous size are drawn as placeholders
+    m_pageRenderer->cancelAll();
+    m_renderRequests.clear();
+
     q->viewport()->update();
 }
 
+void QPdfViewPrivate::cancelInvisibleRequests()
+{
+    // tiles that have been scrolled out of reach before they were rendered are not needed anymore
+    const QRect area = requestArea();
+
+    for (auto it = m_renderRequests.begin(); it != m_renderRequests.end(); ) {
+        if (tileGeometry(it.key()).intersects(area)) {
+            ++it;
+        } else {
+            m_pageRenderer->cancelRequest(it.value());
+            it = m_renderRequests.erase(it);
+        }
+    }
+}
+
+// Returns the area the tile covers in the document layout, or an empty rect if the tile
+// lies outside of its page.
+QRect QPdfViewPrivate::tileGeometry(const QPdfViewTile &tile) const
+{
+    const QRect pageGeometry = m_documentLayout.pageGeometry(tile.page);
+    const QRect tileRect(pageGeometry.topLeft() + tile.tile * TileSize, QSize(TileSize, TileSize));
+
+    return tileRect.intersected(pageGeometry);
+}
+
+QPdfDocumentRenderOptions QPdfViewPrivate::tileOptions(const QPdfViewTile &tile) const
+{
+    QPdfDocumentRenderOptions options = m_documentOptions;
+    options.setTile(tile.tile, TileSize);
+
+    return options;
+}
+
+void QPdfViewPrivate::evictTiles()
+{
+    QPdfRenderCache *cache = renderCache();
+    if (cache->size() <= cache->maximumSize() / 4 * 3)
+        return;
+
+    if (!m_evictionCandidatesValid)
+        updateEvictionCandidates();
+
+    const qint64 targetSize = cache->maximumSize() / 8 * 5;
+    while (cache->size() > targetSize && !m_evictionCandidates.isEmpty()) {
+        const QPdfViewTile tile = m_evictionCandidates.takeLast();
+
+        // tiles the cache has dropped on its own in the meantime are skipped
+        const auto it = m_cachedTiles.find(tile);
+        if (it == m_cachedTiles.end())
+            continue;
+
+        cache->remove(tile.page, it->pageSize, it->options);
+        m_cachedTiles.erase(it);
+    }
+}
+
+// The cache itself drops the least recently drawn images, which after a jump of the
+// viewport are the ones around its new position. So the tiles outside of the request
+// area are dropped before it fills up: those of outdated layouts first, then those
+// farthest from the viewport.
+void QPdfViewPrivate::updateEvictionCandidates()
+{
+    QPdfRenderCache *cache = renderCache();
+    const QRect area = requestArea();
+    const QPoint center = m_viewport.center();
+
+    QVector<QPair<qint64, QPdfViewTile>> candidates;
+    for (auto it = m_cachedTiles.begin(); it != m_cachedTiles.end(); ) {
+        const QPdfViewTile &tile = it.key();
+        const QPdfViewRendering &rendering = it.value();
+
+        if (!cache->contains(tile.page, rendering.pageSize, rendering.options)) {
+            it = m_cachedTiles.erase(it);
+            continue;
+        }
+
+        const QRect geometry = tileGeometry(tile);
+        const bool current = (rendering.pageSize == m_documentLayout.pageGeometry(tile.page).size());
+
+        if (!current) {
+            candidates.append(qMakePair(std::numeric_limits<qint64>::max(), tile));
+        } else if (!geometry.intersects(area)) {
+            const QPoint offset = geometry.center() - center;
+            candidates.append(qMakePair(qint64(offset.x()) * offset.x() + qint64(offset.y()) * offset.y(), tile));
+        }
+
+        ++it;
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const QPair<qint64, QPdfViewTile> &lhs, const QPair<qint64, QPdfViewTile> &rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    m_evictionCandidates.clear();
+    m_evictionCandidates.reserve(candidates.size());
+    for (const auto &candidate : qAsConst(candidates))
+        m_evictionCandidates.append(candidate.second);
+
+    m_evictionCandidatesValid = true;
+}
+
+void QPdfViewPrivate::paintPage(QPainter *painter, int page, const QRect &pageGeometry)
+{
+    const QRect visibleArea = pageGeometry.intersected(m_viewport).translated(-pageGeometry.topLeft());
+
+    QVector<QPair<QPoint, QImage>> tiles;
+    bool complete = true;
+
+    for (int row = visibleArea.top() / TileSize; row <= visibleArea.bottom() / TileSize; ++row) {
+        for (int column = visibleArea.left() / TileSize; column <= visibleArea.right() / TileSize; ++column) {
+            const QPdfViewTile tile = { page, QPoint(column, row) };
+            const QImage image = renderCache()->image(page, pageGeometry.size(), tileOptions(tile));
+            if (image.isNull())
+                complete = false;
+            else
+                tiles.append(qMakePair(tileGeometry(tile).topLeft(), image));
+        }
+    }
+
+    if (complete) {
+        // the stale tiles are not drawn anymore and leave the cache first
+        m_placeholders.insert(page, { pageGeometry.size(), m_documentOptions });
+    } else {
+        paintPlaceholder(painter, page, pageGeometry);
+    }
+
+    for (const auto &tile : qAsConst(tiles))
+        painter->drawImage(tile.first, tile.second);
+}
+
+void QPdfViewPrivate::paintPlaceholder(QPainter *painter, int page, const QRect &pageGeometry)
+{
+    const auto it = m_placeholders.constFind(page);
+    if (it == m_placeholders.cend())
+        return;
+
+    const QPdfViewRendering &placeholder = it.value();
+    if (placeholder.pageSize == pageGeometry.size() || placeholder.pageSize.isEmpty()
+            || placeholder.options.rotation() != m_documentOptions.rotation())
+        return;
+
+    const qreal scaleX = qreal(pageGeometry.width()) / placeholder.pageSize.width();
+    const qreal scaleY = qreal(pageGeometry.height()) / placeholder.pageSize.height();
+
+    // the visible part of the page in the coordinates of its previous size
+    const QRectF visibleArea = QRectF(pageGeometry.intersected(m_viewport).translated(-pageGeometry.topLeft()));
+    const QRect area = QRectF(visibleArea.x() / scaleX, visibleArea.y() / scaleY,
+                              visibleArea.width() / scaleX, visibleArea.height() / scaleY).toAlignedRect()
+                       & QRect(QPoint(), placeholder.pageSize);
+    if (area.isEmpty())
+        return;
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    for (int row = area.top() / TileSize; row <= area.bottom() / TileSize; ++row) {
+        for (int column = area.left() / TileSize; column <= area.right() / TileSize; ++column) {
+            QPdfDocumentRenderOptions options = placeholder.options;
+            options.setTile(QPoint(column, row), TileSize);
+
+            const QImage image = renderCache()->image(page, placeholder.pageSize, options);
+            if (image.isNull())
+                continue;
+
+            const QRectF target(pageGeometry.x() + column * TileSize * scaleX, pageGeometry.y() + row * TileSize * scaleY,
+                                image.width() * scaleX, image.height() * scaleY);
+            painter->drawImage(target, image);
+        }
+    }
+
+    painter->restore();
+}
+
+QRect QPdfViewPrivate::requestArea() const
+{
+    QRect area = m_viewport.adjusted(-TileMargin, -TileMargin, TileMargin, TileMargin);
+
+    if (m_pageMode != QPdfView::MultiPage || m_scrollDirection == 0)
+        return area;
+
+    const bool scrolling = (m_scrollTimer.elapsed() - m_lastScrollTime <= ScrollIdleTime);
+    int ahead = qMax(m_prefetchPixels, scrolling ? qRound(m_scrollVelocity * PrefetchTime) : 0);
+
+    const int currentPage = m_pageNavigation->currentPage();
+    for (int i = 1; i <= m_prefetchPages; ++i) {
+        const QRect pageGeometry = m_documentLayout.pageGeometry(currentPage + i * m_scrollDirection);
+        if (pageGeometry.isNull())
+            break;
+
+        ahead = qMax(ahead, m_scrollDirection > 0 ? pageGeometry.bottom() - area.bottom()
+                                                  : area.top() - pageGeometry.top());
+    }
+
+    // the prefetched tiles must not push the visible ones out of the cache, so all
+    // tiles of the request area together take at most half of its budget
+    const qint64 budget = renderCache()->maximumSize() / 2;
+    const qint64 bytesPerLine = 4 * qint64(qMax(area.width(), 1));
+    ahead = int(qBound<qint64>(0, ahead, budget / bytesPerLine - area.height()));
+
+    if (m_scrollDirection > 0)
+        area.setBottom(area.bottom() + ahead);
+    else
+        area.setTop(area.top() - ahead);
+
+    return area;
+}
+
+void QPdfViewPrivate::requestTiles(int page, const QRect &area, QPdfPageRenderer::RequestPriority priority)
+{
+    const QRect pageGeometry = m_documentLayout.pageGeometry(page);
+    const QRect pageArea = area.intersected(pageGeometry).translated(-pageGeometry.topLeft());
+    if (pageArea.isEmpty())
+        return;
+
+    for (int row = pageArea.top() / TileSize; row <= pageArea.bottom() / TileSize; ++row) {
+        for (int column = pageArea.left() / TileSize; column <= pageArea.right() / TileSize; ++column) {
+            const QPdfViewTile tile = { page, QPoint(column, row) };
+            const QPdfDocumentRenderOptions options = tileOptions(tile);
+            if (renderCache()->contains(page, pageGeometry.size(), options))
+                continue;
+
+            const auto failed = m_failedTiles.constFind(tile);
+            if (failed != m_failedTiles.cend() && failed->pageSize == pageGeometry.size() && failed->options == options)
+                continue;
+
+            const quint64 requestId = m_pageRenderer->requestPage(page, pageGeometry.size(), options, priority);
+            if (requestId != 0)
+                m_renderRequests.insert(tile, requestId);
+        }
+    }
+}
+
+QPdfRenderCache *QPdfViewPrivate::renderCache() const
+{
+    QPdfRenderCache *cache = m_pageRenderer->renderCache();
+
+    // a shared cache of another document is of no use to the view
+    return (cache->document() == m_document ? cache : m_defaultRenderCache);
+}
+
+QRect QPdfViewPrivate::DocumentLayout::pageGeometry(int page) const
+{
+    if (!contains(page))
+        return QRect();
+
+    const int index = page - firstPage;
+
+    const QSize pageSize = (isUniform() ? uniformPageSize : pageSizes.at(index));
+    const int pageY = (isUniform() ? pageTop + index * (uniformPageSize.height() + pageSpacing) : pageOffsets.at(index));
+
+    // center horizontal inside the viewport
+    const int pageX = (contentWidth - pageSize.width()) / 2;
+
+    return QRect(QPoint(pageX, pageY), pageSize);
+}
+
+// Returns the last page starting above or at y, or the first page if there is none, or -1 if there are no pages.
+int QPdfViewPrivate::DocumentLayout::pageAt(int y) const
+{
+    if (pageCount == 0)
+        return -1;
+
+    int index;
+    if (isUniform()) {
+        const int stride = qMax(uniformPageSize.height() + pageSpacing, 1);
+        index = (y >= pageTop ? (y - pageTop) / stride : 0);
+    } else {
+        index = int(std::upper_bound(pageOffsets.constBegin(), pageOffsets.constEnd(), y) - pageOffsets.constBegin()) - 1;
+    }
+
+    return firstPage + qBound(0, index, pageCount - 1);
+}
+
 QPdfViewPrivate::DocumentLayout QPdfViewPrivate::calculateDocumentLayout() const
 {
     // The DocumentLayout describes a virtual layout where all pages are positioned inside
@@ -206,27 +565,34 @@ QPdfViewPrivate::DocumentLayout QPdfViewPrivate::calculateDocumentLayout() const
     if (!m_document || m_document->status() != QPdfDocument::Ready)
         return documentLayout;
 
-    QHash<int, QRect> pageGeometries;
-
     const int pageCount = m_document->pageCount();
+    const QVector<QSizeF> pageSizes = m_document->pageSizes();
+
+    // pages that have not been loaded yet are laid out with the size of the first available one
+    QSizeF placeholderSize;
+    for (int page = 0; page < pageSizes.size() && !placeholderSize.isValid(); ++page)
+        placeholderSize = pageSizes.at(page);
 
     int totalWidth = 0;
 
     const int startPage = (m_pageMode == QPdfView::SinglePage ? m_pageNavigation->currentPage() : 0);
     const int endPage = (m_pageMode == QPdfView::SinglePage ? m_pageNavigation->currentPage() + 1 : pageCount);
 
+    QVector<QSize> layoutSizes;
+    layoutSizes.reserve(endPage - startPage);
+    bool uniform = true;
+
     // calculate page sizes
     for (int page = startPage; page < endPage; ++page) {
 
         /*!
          * Swaps the width and height of the page if it is rotated by 90 or 270 degrees.
          */
-        QSizeF pageSizeF;
-        if (m_documentOptions.rotation() == 1 || m_documentOptions.rotation() == 3) {
-            pageSizeF = QSizeF(m_document->pageSize(page).height(), m_document->pageSize(page).width());
-        } else {
-            pageSizeF = QSizeF(m_document->pageSize(page));
-        }
+        QSizeF pageSizeF = pageSizes.value(page);
+        if (!pageSizeF.isValid())
+            pageSizeF = placeholderSize;
+        if (m_documentOptions.rotation() == 1 || m_documentOptions.rotation() == 3)
+            pageSizeF.transpose();
 
         QSize pageSize;
         if (m_zoomMode == QPdfView::CustomZoom) {
@@ -244,29 +610,41 @@ QPdfViewPrivate::DocumentLayout QPdfViewPrivate::calculateDocumentLayout() const
 
         totalWidth = qMax(totalWidth, pageSize.width());
 
-        pageGeometries[page] = QRect(QPoint(0, 0), pageSize);
+        if (!layoutSizes.isEmpty() && pageSize != layoutSizes.constFirst())
+            uniform = false;
+
+        layoutSizes.append(pageSize);
     }
 
     totalWidth += m_documentMargins.left() + m_documentMargins.right();
 
+    documentLayout.firstPage = startPage;
+    documentLayout.pageCount = layoutSizes.size();
+    documentLayout.pageTop = m_documentMargins.top();
+    documentLayout.pageSpacing = m_pageSpacing;
+    documentLayout.contentWidth = qMax(totalWidth, m_viewport.width());
+
     int pageY = m_documentMargins.top();
 
     // calculate page positions
-    for (int page = startPage; page < endPage; ++page) {
-        const QSize pageSize = pageGeometries[page].size();
-
-        // center horizontal inside the viewport
-        const int pageX = (qMax(totalWidth, m_viewport.width()) - pageSize.width()) / 2;
+    if (uniform) {
+        if (!layoutSizes.isEmpty()) {
+            documentLayout.uniformPageSize = layoutSizes.constFirst();
+            pageY += layoutSizes.size() * (documentLayout.uniformPageSize.height() + m_pageSpacing);
+        }
+    } else {
+        documentLayout.pageOffsets.reserve(layoutSizes.size());
 
-        pageGeometries[page].moveTopLeft(QPoint(pageX, pageY));
+        for (const QSize &pageSize : qAsConst(layoutSizes)) {
+            documentLayout.pageOffsets.append(pageY);
+            pageY += pageSize.height() + m_pageSpacing;
+        }
 
-        pageY += pageSize.height() + m_pageSpacing;
+        documentLayout.pageSizes = layoutSizes;
     }
 
     pageY += m_documentMargins.bottom();
 
-    documentLayout.pageGeometries = pageGeometries;
-
     // calculate overall document size
     documentLayout.documentSize = QSize(totalWidth, pageY);
 
@@ -275,16 +653,17 @@ QPdfViewPrivate::DocumentLayout QPdfViewPrivate::calculateDocumentLayout() const
 
 qreal QPdfViewPrivate::yPositionForPage(int pageNumber) const
 {
-    const auto it = m_documentLayout.pageGeometries.constFind(pageNumber);
-    if (it == m_documentLayout.pageGeometries.cend())
+    if (!m_documentLayout.contains(pageNumber))
         return 0.0;
 
-    return (*it).y();
+    return m_documentLayout.pageGeometry(pageNumber).y();
 }
 
 void QPdfViewPrivate::updateDocumentLayout()
 {
     m_documentLayout = calculateDocumentLayout();
+    m_failedTiles.clear();
+    m_evictionCandidatesValid = false;
 
     updateScrollBars();
 }
@@ -300,7 +679,7 @@ QPdfView::QPdfView(QWidget *parent)
     connect(d->m_pageNavigation, &QPdfPageNavigation::currentPageChanged, this, [d](int page){ d->currentPageChanged(page); });
 
     connect(d->m_pageRenderer, &QPdfPageRenderer::pageRendered,
-            this, [d](int pageNumber, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions, quint64 requestId){ d->pageRendered(pageNumber, imageSize, image, requestId); });
+            this, [d](int pageNumber, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId){ d->pageRendered(pageNumber, imageSize, image, options, requestId); });
 
     verticalScrollBar()->setSingleStep(20);
     horizontalScrollBar()->setSingleStep(20);
@@ -329,17 +708,22 @@ void QPdfView::setDocument(QPdfDocument *document)
     if (d->m_document == document)
         return;
 
-    if (d->m_document)
+    if (d->m_document) {
         disconnect(d->m_documentStatusChangedConnection);
+        disconnect(d->m_pageAvailableConnection);
+    }
 
     d->m_document = document;
     emit documentChanged(d->m_document);
 
-    if (d->m_document)
+    if (d->m_document) {
         d->m_documentStatusChangedConnection = connect(d->m_document.data(), &QPdfDocument::statusChanged, this, [d](){ d->documentStatusChanged(); });
+        d->m_pageAvailableConnection = connect(d->m_document.data(), &QPdfDocument::pageAvailable, this, [d](int page){ d->pageAvailable(page); });
+    }
 
     d->m_pageNavigation->setDocument(d->m_document);
     d->m_pageRenderer->setDocument(d->m_document);
+    d->m_defaultRenderCache->setDocument(d->m_document);
 
     d->documentStatusChanged();
 }
@@ -358,6 +742,58 @@ QPdfPageNavigation *QPdfView::pageNavigation() const
     return d->m_pageNavigation;
 }
 
+/*!
+ * Returns the cache the view keeps its rendered pages in. Unless another cache has been
+ * set with setRenderCache(), this is a cache owned by the view.
+ */
+QPdfRenderCache *QPdfView::renderCache() const
+{
+    Q_D(const QPdfView);
+
+    return d->m_pageRenderer->renderCache();
+}
+
+/*!
+ * Sets the \a cache the view keeps its rendered pages in, e.g. to share them with other
+ * views of the same document. Pages found in the cache are not rendered again.
+ * Passing \c nullptr restores the cache owned by the view.
+ */
+void QPdfView::setRenderCache(QPdfRenderCache *cache)
+{
+    Q_D(QPdfView);
+
+    d->m_pageRenderer->setRenderCache(cache ? cache : d->m_defaultRenderCache);
+    d->m_cachedTiles.clear();
+    d->m_evictionCandidatesValid = false;
+    viewport()->update();
+}
+
+/*!
+ * Returns the number of bytes the rendered pages of the view may take in memory.
+ *
+ * \sa renderCache()
+ */
+qint64 QPdfView::maximumPageCacheSize() const
+{
+    Q_D(const QPdfView);
+
+    return d->renderCache()->maximumSize();
+}
+
+/*!
+ * Sets the number of \a bytes the rendered pages of the view may take in memory.
+ * The least recently drawn pages are dropped first once the limit is exceeded.
+ *
+ * If the view shares a cache set with setRenderCache(), the limit applies to that
+ * cache and thus to all of its users.
+ */
+void QPdfView::setMaximumPageCacheSize(qint64 bytes)
+{
+    Q_D(QPdfView);
+
+    d->renderCache()->setMaximumSize(bytes);
+}
+
 QPdfView::PageMode QPdfView::pageMode() const
 {
     Q_D(const QPdfView);
@@ -438,6 +874,63 @@ void QPdfView::setPageSpacing(int spacing)
     emit pageSpacingChanged(d->m_pageSpacing);
 }
 
+int QPdfView::prefetchPages() const
+{
+    Q_D(const QPdfView);
+
+    return d->m_prefetchPages;
+}
+
+/*!
+ * Sets the number of \a pages ahead of the current page in scroll direction which are
+ * rendered in advance while scrolling in MultiPage mode.
+ * Prefetched tiles are rendered after the visible ones and take at most half of the
+ * page cache, see maximumPageCacheSize().
+ */
+void QPdfView::setPrefetchPages(int pages)
+{
+    Q_D(QPdfView);
+
+    pages = qMax(pages, 0);
+
+    if (d->m_prefetchPages == pages)
+        return;
+
+    d->m_prefetchPages = pages;
+    d->cancelInvisibleRequests();
+    viewport()->update();
+
+    emit prefetchPagesChanged(d->m_prefetchPages);
+}
+
+int QPdfView::prefetchPixels() const
+{
+    Q_D(const QPdfView);
+
+    return d->m_prefetchPixels;
+}
+
+/*!
+ * Sets the number of \a pixels ahead of the viewport in scroll direction which are
+ * rendered in advance while scrolling in MultiPage mode.
+ * The area grows with the scroll velocity, see setPrefetchPages().
+ */
+void QPdfView::setPrefetchPixels(int pixels)
+{
+    Q_D(QPdfView);
+
+    pixels = qMax(pixels, 0);
+
+    if (d->m_prefetchPixels == pixels)
+        return;
+
+    d->m_prefetchPixels = pixels;
+    d->cancelInvisibleRequests();
+    viewport()->update();
+
+    emit prefetchPixelsChanged(d->m_prefetchPixels);
+}
+
 /*!
  * Sets the rotation of the render options to 0, 90, 180 or 270 degrees.
  * Invalidates the document layout and emits zoomFactorChanged(float).
@@ -497,23 +990,33 @@ void QPdfView::paintEvent(QPaintEvent *event)
     painter.fillRect(event->rect(), palette().brush(QPalette::Dark));
     painter.translate(-d->m_viewport.x(), -d->m_viewport.y());
 
-    for (auto it = d->m_documentLayout.pageGeometries.cbegin(); it != d->m_documentLayout.pageGeometries.cend(); ++it) {
-        const QRect pageGeometry = it.value();
+    const QRect requestArea = d->requestArea();
+
+    // only the pages from the one at the top of the request area to the one at its bottom are looked at
+    const int firstPage = d->m_documentLayout.pageAt(requestArea.top());
+    const int lastPage = d->m_documentLayout.pageAt(requestArea.bottom());
+
+    for (int page = firstPage; page >= 0 && page <= lastPage; ++page) {
+        const QRect pageGeometry = d->m_documentLayout.pageGeometry(page);
+        if (!pageGeometry.intersects(requestArea))
+            continue;
+
         if (pageGeometry.intersects(d->m_viewport)) { // page needs to be painted
             painter.fillRect(pageGeometry, Qt::white);
+            d->paintPage(&painter, page, pageGeometry);
+        }
 
-            const int page = it.key();
-            const auto pageIt = d->m_pageCache.constFind(page);
-            if (pageIt != d->m_pageCache.cend()) {
-                const QImage &img = pageIt.value();
-                painter.drawImage(pageGeometry.topLeft(), img);
-            } else {
-                /*!
-                 * Uses m_documentOptions when rendering a new page.
-                 */
-                d->m_pageRenderer->requestPage(page, pageGeometry.size(), d->m_documentOptions);
-            }
+        if (!d->m_document->isPageAvailable(page)) {
+            d->m_document->requestPage(page);
+            continue;
         }
+
+        /*!
+         * Uses m_documentOptions when rendering new tiles. The visible ones come first,
+         * the ones in the margin around the viewport are rendered in advance.
+         */
+        d->requestTiles(page, d->m_viewport, QPdfPageRenderer::VisiblePriority);
+        d->requestTiles(page, requestArea, QPdfPageRenderer::PrefetchPriority);
     }
 }
 
@@ -45,6 +45,7 @@ QT_BEGIN_NAMESPACE
 
 class QPdfDocument;
 class QPdfPageNavigation;
+class QPdfRenderCache;
 class QPdfViewPrivate;
 
 class Q_PDF_WIDGETS_EXPORT QPdfView : public QAbstractScrollArea
@@ -60,6 +61,9 @@ class Q_PDF_WIDGETS_EXPORT QPdfView : public QAbstractScrollArea
     Q_PROPERTY(int pageSpacing READ pageSpacing WRITE setPageSpacing NOTIFY pageSpacingChanged)
     Q_PROPERTY(QMargins documentMargins READ documentMargins WRITE setDocumentMargins NOTIFY documentMarginsChanged)
 
+    Q_PROPERTY(int prefetchPages READ prefetchPages WRITE setPrefetchPages NOTIFY prefetchPagesChanged)
+    Q_PROPERTY(int prefetchPixels READ prefetchPixels WRITE setPrefetchPixels NOTIFY prefetchPixelsChanged)
+
 public:
     enum PageMode
     {
@@ -84,6 +88,12 @@ public:
 
     QPdfPageNavigation *pageNavigation() const;
 
+    QPdfRenderCache *renderCache() const;
+    void setRenderCache(QPdfRenderCache *cache);
+
+    qint64 maximumPageCacheSize() const;
+    void setMaximumPageCacheSize(qint64 bytes);
+
     PageMode pageMode() const;
     ZoomMode zoomMode() const;
     qreal zoomFactor() const;
@@ -94,6 +104,12 @@ public:
     QMargins documentMargins() const;
     void setDocumentMargins(QMargins margins);
 
+    int prefetchPages() const;
+    void setPrefetchPages(int pages);
+
+    int prefetchPixels() const;
+    void setPrefetchPixels(int pixels);
+
     void setRenderFlags(QPdf::RenderFlags);
     void setRotation(QPdf::Rotation);
 
@@ -109,6 +125,8 @@ Q_SIGNALS:
     void zoomFactorChanged(qreal zoomFactor);
     void pageSpacingChanged(int pageSpacing);
     void documentMarginsChanged(QMargins documentMargins);
+    void prefetchPagesChanged(int prefetchPages);
+    void prefetchPixelsChanged(int prefetchPixels);
 
 protected:
     explicit QPdfView(QPdfViewPrivate &, QWidget *);
@@ -50,14 +50,48 @@
 
 #include "qpdfview.h"
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
 #include <QPointer>
+#include <QVector>
 #include <QtWidgets/private/qabstractscrollarea_p.h>
 
 #include <QPdfDocumentRenderOptions>
+#include <QPdfPageRenderer>
+#include <QPdfRenderCache>
 
 QT_BEGIN_NAMESPACE
 
-class QPdfPageRenderer;
+class QPainter;
+
+// A square of QPdfViewPrivate::TileSize pixels of a page as it is laid out in the view
+struct QPdfViewTile
+{
+    int page;
+    QPoint tile;
+};
+
+Q_DECLARE_TYPEINFO(QPdfViewTile, Q_PRIMITIVE_TYPE);
+
+inline bool operator==(const QPdfViewTile &lhs, const QPdfViewTile &rhs)
+{
+    return lhs.page == rhs.page && lhs.tile == rhs.tile;
+}
+
+inline uint qHash(const QPdfViewTile &key, uint seed = 0)
+{
+    return qHash(key.page, seed) ^ (uint(key.tile.x()) << 16) ^ uint(key.tile.y());
+}
+
+// The page size and the options a page or a tile of it has been rendered with
+struct QPdfViewRendering
+{
+    QSize pageSize;
+    QPdfDocumentRenderOptions options;
+};
+
+Q_DECLARE_TYPEINFO(QPdfViewRendering, Q_MOVABLE_TYPE);
 
 class QPdfViewPrivate : public QAbstractScrollAreaPrivate
 {
@@ -68,21 +102,70 @@ public:
     void init();
 
     void documentStatusChanged();
+    void pageAvailable(int page);
     void currentPageChanged(int currentPage);
     void calculateViewport();
     void setViewport(QRect viewport);
     void updateScrollBars();
 
-    void pageRendered(int pageNumber, QSize imageSize, const QImage &image, quint64 requestId);
+    void pageRendered(int pageNumber, QSize imageSize, const QImage &image,
+                      QPdfDocumentRenderOptions options, quint64 requestId);
     void invalidateDocumentLayout();
     void invalidatePageCache();
+    void cancelInvisibleRequests();
+
+    // Pages are rendered in tiles, so that the memory taken by the images depends on the
+    // size of the viewport rather than on the zoom factor. The tiles around the viewport
+    // are requested in advance, and those farthest from it are dropped first.
+    enum { TileSize = 512, TileMargin = TileSize };
+
+    // While scrolling, the pages ahead are requested as well: m_prefetchPages pages after the
+    // current one, or m_prefetchPixels, or as far as the view scrolls within PrefetchTime
+    // milliseconds, whichever reaches farthest. A scroll pause of ScrollIdleTime milliseconds
+    // resets the velocity.
+    enum { PrefetchTime = 1000, ScrollIdleTime = 250 };
+
+    void updateScrollVelocity(int dy);
+
+    QRect tileGeometry(const QPdfViewTile &tile) const;
+    QPdfDocumentRenderOptions tileOptions(const QPdfViewTile &tile) const;
+    QRect requestArea() const;
+    void requestTiles(int page, const QRect &area, QPdfPageRenderer::RequestPriority priority);
+    QPdfRenderCache *renderCache() const;
+    void evictTiles();
+    void updateEvictionCandidates();
+
+    void paintPage(QPainter *painter, int page, const QRect &pageGeometry);
+    void paintPlaceholder(QPainter *painter, int page, const QRect &pageGeometry);
 
     qreal yPositionForPage(int page) const;
 
+    // The pages firstPage to lastPage() are placed below each other. If they all share the same
+    // size, only uniformPageSize is stored and their positions follow from it, otherwise pageSizes
+    // holds the size and pageOffsets the ascending y position of each of them. Thus the geometry
+    // of a page is found in constant time, and the page at a position by a binary search.
     struct DocumentLayout
     {
+        DocumentLayout() : firstPage(0), pageCount(0), pageTop(0), pageSpacing(0), contentWidth(0) {}
+
+        bool contains(int page) const { return page >= firstPage && page < firstPage + pageCount; }
+        int lastPage() const { return firstPage + pageCount - 1; }
+        bool isUniform() const { return pageOffsets.isEmpty(); }
+
+        QRect pageGeometry(int page) const;
+        int pageAt(int y) const;
+
         QSize documentSize;
-        QHash<int, QRect> pageGeometries;
+
+        int firstPage;
+        int pageCount;
+        int pageTop; // y position of firstPage
+        int pageSpacing;
+        int contentWidth; // width the pages are centered in
+
+        QSize uniformPageSize;
+        QVector<QSize> pageSizes;
+        QVector<int> pageOffsets;
     };
 
     DocumentLayout calculateDocumentLayout() const;
@@ -100,14 +183,41 @@ public:
     QMargins m_documentMargins;
 
     bool m_blockPageScrolling;
+    bool m_layoutUpdatePending;
 
     QMetaObject::Connection m_documentStatusChangedConnection;
+    QMetaObject::Connection m_pageAvailableConnection;
 
     QRect m_viewport;
 
-    QHash<int, QImage> m_pageCache;
-    QVector<int> m_cachedPagesLRU;
-    int m_pageCacheLimit;
+    int m_prefetchPages;
+    int m_prefetchPixels;
+
+    QElapsedTimer m_scrollTimer;
+    qint64 m_lastScrollTime;
+    qreal m_scrollVelocity; // pixels per millisecond
+    int m_scrollDirection; // 1 downwards, -1 upwards, 0 not scrolled yet
+
+    // The rendered tiles are kept in the render cache of m_pageRenderer, keyed by the size of
+    // the page and the tile in the render options, so that only tiles of the current layout are
+    // drawn. The cache is m_defaultRenderCache unless one is shared through setRenderCache().
+    QPdfRenderCache *m_defaultRenderCache;
+    QHash<QPdfViewTile, quint64> m_renderRequests; // tile -> id of the request that renders it
+    QHash<QPdfViewTile, QPdfViewRendering> m_cachedTiles; // tile -> its latest rendering in the cache
+
+    // Tiles that could not be rendered are not requested again until the layout or the
+    // document changes, since the cache does not keep their null images
+    QHash<QPdfViewTile, QPdfViewRendering> m_failedTiles;
+
+    // The cached tiles outside of the request area, the one to drop first at the end. They are
+    // only sorted again once the viewport or the layout has changed, so that the tiles arriving
+    // in between do not each cost a pass over all cached tiles.
+    QVector<QPdfViewTile> m_evictionCandidates;
+    bool m_evictionCandidatesValid;
+
+    // The last complete rendering of each page, whose tiles stand in for the missing ones
+    // after the page has been resized
+    QHash<int, QPdfViewRendering> m_placeholders;
 
     QPdfDocumentRenderOptions m_documentOptions;
     DocumentLayout m_documentLayout;
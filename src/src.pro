@@ -3,7 +3,10 @@ TEMPLATE = subdirs
 src_pdf.subdir = pdf
 src_pdf.depends = lib
 
-SUBDIRS = lib src_pdf
+src_pdfrenderprocess.subdir = pdfrenderprocess
+src_pdfrenderprocess.depends = src_pdf
+
+SUBDIRS = lib src_pdf src_pdfrenderprocess
 
 qtHaveModule(widgets) {
     src_pdfwidgets.subdir = pdfwidgets
@@ -1,8 +1,19 @@
 TEMPLATE = subdirs
 
 SUBDIRS = \
+    qpdfblockcache \
     qpdfbookmarkmodel \
+    qpdfchunkedbuffer \
+    qpdfdiskcache \
     qpdfpagenavigation \
-    qpdfpagerenderer
+    qpdfpagerenderer \
+    qpdfrendercache \
+    qpdfrenderprocess
+
+# tests of classes that are only exported in developer builds
+!qtConfig(private_tests): SUBDIRS -= \
+    qpdfblockcache \
+    qpdfchunkedbuffer \
+    qpdfrenderprocess
 
 qtHaveModule(printsupport): SUBDIRS += qpdfdocument
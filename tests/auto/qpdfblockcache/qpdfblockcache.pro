@@ -0,0 +1,5 @@
+CONFIG += testcase
+TARGET = tst_qpdfblockcache
+QT += pdf-private testlib
+macos:CONFIG -= app_bundle
+SOURCES += tst_qpdfblockcache.cpp
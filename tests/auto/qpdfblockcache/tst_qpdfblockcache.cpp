@@ -0,0 +1,207 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtPdf/private/qpdfblockcache_p.h>
+
+#include <QBuffer>
+#include <QTemporaryFile>
+#include <QtTest/QtTest>
+
+// A device that is not a QFileDevice, so the cache reads it with seek() and read()
+class CountingBuffer : public QBuffer
+{
+public:
+    explicit CountingBuffer(const QByteArray &data)
+        : readCount(0)
+    {
+        setData(data);
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    int readCount;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        ++readCount;
+        return QBuffer::readData(data, maxSize);
+    }
+};
+
+static QByteArray testData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        data[i] = char(i % 251);
+
+    return data;
+}
+
+class tst_QPdfBlockCache: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaultValues();
+    void readAcrossBlocks_data();
+    void readAcrossBlocks();
+    void readFromFile();
+    void eviction();
+    void noCache();
+};
+
+void tst_QPdfBlockCache::defaultValues()
+{
+    QPdfBlockCache cache;
+
+    QCOMPARE(cache.blockSize(), 16 * 1024);
+    QCOMPARE(cache.capacity(), 256);
+}
+
+void tst_QPdfBlockCache::readAcrossBlocks_data()
+{
+    QTest::addColumn<qint64>("position");
+    QTest::addColumn<qint64>("size");
+    QTest::addColumn<qint64>("expectedSize");
+
+    QTest::newRow("within a block") << qint64(1) << qint64(5) << qint64(5);
+    QTest::newRow("up to a block boundary") << qint64(8) << qint64(8) << qint64(8);
+    QTest::newRow("across a block boundary") << qint64(14) << qint64(4) << qint64(4);
+    QTest::newRow("across several blocks") << qint64(3) << qint64(40) << qint64(40);
+    QTest::newRow("up to the end") << qint64(90) << qint64(10) << qint64(10);
+    QTest::newRow("past the end") << qint64(90) << qint64(20) << qint64(10);
+    QTest::newRow("beyond the end") << qint64(120) << qint64(4) << qint64(0);
+}
+
+void tst_QPdfBlockCache::readAcrossBlocks()
+{
+    QFETCH(qint64, position);
+    QFETCH(qint64, size);
+    QFETCH(qint64, expectedSize);
+
+    const QByteArray data = testData(100);
+    CountingBuffer device(data);
+
+    QPdfBlockCache cache;
+    cache.setBlockSize(16);
+    cache.setDevice(&device, data.size());
+
+    QByteArray result(int(size), '\0');
+    QCOMPARE(cache.read(position, result.data(), size), expectedSize);
+    QCOMPARE(result.left(int(expectedSize)), data.mid(int(position), int(expectedSize)));
+
+    // the second read is served from the cached blocks
+    const int readCount = device.readCount;
+    QByteArray again(int(size), '\0');
+    QCOMPARE(cache.read(position, again.data(), size), expectedSize);
+    QCOMPARE(again, result);
+    if (expectedSize > 0)
+        QCOMPARE(device.readCount, readCount);
+}
+
+void tst_QPdfBlockCache::readFromFile()
+{
+    const QByteArray data = testData(1000);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(data), qint64(data.size()));
+    QVERIFY(file.flush());
+
+    QPdfBlockCache cache;
+    cache.setBlockSize(64);
+    cache.setDevice(&file, data.size());
+
+    QByteArray result(500, '\0');
+    QCOMPARE(cache.read(300, result.data(), result.size()), qint64(500));
+    QCOMPARE(result, data.mid(300, 500));
+
+    // positional reads leave the file position alone
+    QCOMPARE(cache.read(990, result.data(), 100), qint64(10));
+    QCOMPARE(result.left(10), data.right(10));
+}
+
+void tst_QPdfBlockCache::eviction()
+{
+    const QByteArray data = testData(100);
+    CountingBuffer device(data);
+
+    QPdfBlockCache cache;
+    cache.setBlockSize(10);
+    cache.setCapacity(2);
+    cache.setDevice(&device, data.size());
+
+    char buffer[10];
+    QCOMPARE(cache.read(0, buffer, 10), qint64(10));
+    QCOMPARE(cache.read(10, buffer, 10), qint64(10));
+    QCOMPARE(device.readCount, 2);
+
+    // the least recently used block is dropped
+    QCOMPARE(cache.read(0, buffer, 10), qint64(10));
+    QCOMPARE(device.readCount, 2);
+    QCOMPARE(cache.read(20, buffer, 10), qint64(10));
+    QCOMPARE(device.readCount, 3);
+    QCOMPARE(cache.read(0, buffer, 10), qint64(10));
+    QCOMPARE(device.readCount, 3);
+    QCOMPARE(cache.read(10, buffer, 10), qint64(10));
+    QCOMPARE(device.readCount, 4);
+    QCOMPARE(QByteArray(buffer, 10), data.mid(10, 10));
+
+    cache.clear();
+    QCOMPARE(cache.read(10, buffer, 10), qint64(10));
+    QCOMPARE(device.readCount, 5);
+}
+
+void tst_QPdfBlockCache::noCache()
+{
+    const QByteArray data = testData(100);
+    CountingBuffer device(data);
+
+    QPdfBlockCache cache;
+    cache.setCapacity(0);
+    cache.setDevice(&device, data.size());
+
+    // without a capacity every read goes to the device
+    QByteArray result(30, '\0');
+    QCOMPARE(cache.read(50, result.data(), result.size()), qint64(30));
+    QCOMPARE(result, data.mid(50, 30));
+    QCOMPARE(cache.read(50, result.data(), result.size()), qint64(30));
+    QCOMPARE(device.readCount, 2);
+}
+
+QTEST_MAIN(tst_QPdfBlockCache)
+
+#include "tst_qpdfblockcache.moc"
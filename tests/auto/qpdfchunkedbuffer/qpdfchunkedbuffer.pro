@@ -0,0 +1,5 @@
+CONFIG += testcase
+TARGET = tst_qpdfchunkedbuffer
+QT += pdf-private testlib
+macos:CONFIG -= app_bundle
+SOURCES += tst_qpdfchunkedbuffer.cpp
@@ -0,0 +1,139 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtPdf/private/qpdfchunkedbuffer_p.h>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfChunkedBuffer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void append();
+    void read_data();
+    void read();
+    void readPastReceivedSize();
+    void clear();
+};
+
+// "abcdefghij" in chunks of 3, 1, 4 and 2 bytes
+static void fill(QPdfChunkedBuffer *buffer)
+{
+    buffer->append(QByteArrayLiteral("abc"));
+    buffer->append(QByteArrayLiteral("d"));
+    buffer->append(QByteArray());
+    buffer->append(QByteArrayLiteral("efgh"));
+    buffer->append(QByteArrayLiteral("ij"));
+}
+
+void tst_QPdfChunkedBuffer::append()
+{
+    QPdfChunkedBuffer buffer;
+    QCOMPARE(buffer.size(), qint64(0));
+
+    fill(&buffer);
+    QCOMPARE(buffer.size(), qint64(10));
+}
+
+void tst_QPdfChunkedBuffer::read_data()
+{
+    QTest::addColumn<qint64>("position");
+    QTest::addColumn<qint64>("size");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("first chunk") << qint64(0) << qint64(3) << QByteArray("abc");
+    QTest::newRow("within a chunk") << qint64(5) << qint64(2) << QByteArray("fg");
+    QTest::newRow("single byte chunk") << qint64(3) << qint64(1) << QByteArray("d");
+    QTest::newRow("across one boundary") << qint64(2) << qint64(2) << QByteArray("cd");
+    QTest::newRow("across several boundaries") << qint64(1) << qint64(8) << QByteArray("bcdefghi");
+    QTest::newRow("from a chunk start") << qint64(4) << qint64(6) << QByteArray("efghij");
+    QTest::newRow("everything") << qint64(0) << qint64(10) << QByteArray("abcdefghij");
+}
+
+void tst_QPdfChunkedBuffer::read()
+{
+    QFETCH(qint64, position);
+    QFETCH(qint64, size);
+    QFETCH(QByteArray, expected);
+
+    QPdfChunkedBuffer buffer;
+    fill(&buffer);
+
+    QByteArray result(int(size), '\0');
+    QCOMPARE(buffer.read(position, result.data(), size), qint64(expected.size()));
+    QCOMPARE(result, expected);
+}
+
+void tst_QPdfChunkedBuffer::readPastReceivedSize()
+{
+    QPdfChunkedBuffer buffer;
+    fill(&buffer);
+
+    char data[16];
+
+    // only what has been received so far is read
+    QCOMPARE(buffer.read(7, data, 16), qint64(3));
+    QCOMPARE(QByteArray(data, 3), QByteArray("hij"));
+    QCOMPARE(buffer.read(10, data, 16), qint64(0));
+    QCOMPARE(buffer.read(100, data, 16), qint64(0));
+    QCOMPARE(buffer.read(-1, data, 16), qint64(0));
+
+    // and more becomes readable once it arrives
+    buffer.append(QByteArrayLiteral("klm"));
+    QCOMPARE(buffer.read(7, data, 16), qint64(6));
+    QCOMPARE(QByteArray(data, 6), QByteArray("hijklm"));
+}
+
+void tst_QPdfChunkedBuffer::clear()
+{
+    QPdfChunkedBuffer buffer;
+    fill(&buffer);
+
+    buffer.clear();
+    QCOMPARE(buffer.size(), qint64(0));
+
+    char data[4];
+    QCOMPARE(buffer.read(0, data, 4), qint64(0));
+
+    buffer.append(QByteArrayLiteral("xyz"));
+    QCOMPARE(buffer.read(1, data, 4), qint64(2));
+    QCOMPARE(QByteArray(data, 2), QByteArray("yz"));
+}
+
+QTEST_MAIN(tst_QPdfChunkedBuffer)
+
+#include "tst_qpdfchunkedbuffer.moc"
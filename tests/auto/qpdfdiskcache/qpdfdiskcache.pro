@@ -0,0 +1,5 @@
+CONFIG += testcase
+TARGET = tst_qpdfdiskcache
+QT += pdf testlib network
+macos:CONFIG -= app_bundle
+SOURCES += tst_qpdfdiskcache.cpp
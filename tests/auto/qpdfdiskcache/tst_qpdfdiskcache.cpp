@@ -0,0 +1,245 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QPdfDiskCache>
+#include <QPdfDocument>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfDiskCache: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaultValues();
+    void fingerprint();
+    void insertAndRequest();
+    void survivesReopening();
+    void maximumSize();
+    void clear();
+};
+
+void tst_QPdfDiskCache::defaultValues()
+{
+    QPdfDiskCache cache;
+
+    QCOMPARE(cache.document(), nullptr);
+    QCOMPARE(cache.path(), QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/qtpdf"));
+    QCOMPARE(cache.maximumSize(), qint64(256 * 1024 * 1024));
+    QVERIFY(cache.fingerprint().isEmpty());
+    QVERIFY(!cache.contains(0, QSize(100, 100)));
+    QCOMPARE(cache.requestImage(0, QSize(100, 100)), quint64(0));
+}
+
+void tst_QPdfDiskCache::fingerprint()
+{
+    QPdfDocument document;
+    QPdfDiskCache cache(&document);
+    QSignalSpy fingerprintChangedSpy(&cache, &QPdfDiskCache::fingerprintChanged);
+
+    // the fingerprint is computed in the background
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.diskcache.pdf")), QPdfDocument::NoError);
+    QTRY_COMPARE(fingerprintChangedSpy.count(), 1);
+    const QByteArray fingerprint = cache.fingerprint();
+    QVERIFY(!fingerprint.isEmpty());
+    QCOMPARE(fingerprintChangedSpy[0][0].toByteArray(), fingerprint);
+
+    // the fingerprint depends on the contents, not on where they are loaded from
+    QFile file(QFINDTESTDATA("pdf-sample.diskcache.pdf"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+    QBuffer buffer;
+    buffer.setData(content);
+    buffer.open(QIODevice::ReadOnly);
+
+    QPdfDocument otherDocument;
+    otherDocument.load(&buffer);
+    QTRY_COMPARE(otherDocument.status(), QPdfDocument::Ready);
+    QPdfDiskCache otherCache(&otherDocument);
+    QTRY_COMPARE(otherCache.fingerprint(), fingerprint);
+
+    // changing a single byte without changing the size gives another fingerprint
+    QByteArray changedContent = content;
+    const int commentIndex = changedContent.indexOf('%', 1);
+    QVERIFY(commentIndex > 0);
+    changedContent[commentIndex + 1] = changedContent.at(commentIndex + 1) + 1;
+    QBuffer changedBuffer;
+    changedBuffer.setData(changedContent);
+    changedBuffer.open(QIODevice::ReadOnly);
+
+    QPdfDocument changedDocument;
+    changedDocument.load(&changedBuffer);
+    QTRY_COMPARE(changedDocument.status(), QPdfDocument::Ready);
+    QPdfDiskCache changedCache(&changedDocument);
+    QTRY_VERIFY(!changedCache.fingerprint().isEmpty());
+    QVERIFY(changedCache.fingerprint() != fingerprint);
+
+    document.close();
+    QVERIFY(cache.fingerprint().isEmpty());
+    QCOMPARE(fingerprintChangedSpy.count(), 2);
+}
+
+void tst_QPdfDiskCache::insertAndRequest()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.diskcache.pdf")), QPdfDocument::NoError);
+
+    QPdfDiskCache cache(&document);
+    cache.setPath(directory.path());
+
+    const QSize imageSize(100, 100);
+    const QImage image = document.render(0, imageSize);
+    cache.insert(0, imageSize, image);
+    QTRY_VERIFY(cache.contains(0, imageSize));
+
+    QPdfDocumentRenderOptions options;
+    options.setRotation(QPdf::Rotate90);
+    QVERIFY(!cache.contains(0, imageSize, options));
+    QVERIFY(!cache.contains(1, imageSize));
+
+    QSignalSpy imageLoadedSpy(&cache, &QPdfDiskCache::imageLoaded);
+    const quint64 requestId = cache.requestImage(0, imageSize);
+    QVERIFY(requestId != 0);
+    QCOMPARE(imageLoadedSpy.count(), 0);
+
+    QTRY_COMPARE(imageLoadedSpy.count(), 1);
+    QCOMPARE(imageLoadedSpy[0][0].toInt(), 0);
+    QCOMPARE(imageLoadedSpy[0][1].toSize(), imageSize);
+    QCOMPARE(imageLoadedSpy[0][2].value<QImage>(), image);
+    QCOMPARE(imageLoadedSpy[0][4].toULongLong(), requestId);
+}
+
+void tst_QPdfDiskCache::survivesReopening()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    const QSize imageSize(100, 100);
+    QImage image;
+
+    {
+        QPdfDocument document;
+        QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.diskcache.pdf")), QPdfDocument::NoError);
+
+        QPdfDiskCache cache(&document);
+        cache.setPath(directory.path());
+
+        image = document.render(1, imageSize);
+        cache.insert(1, imageSize, image);
+
+        // the destructor waits for the image to be written
+    }
+
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.diskcache.pdf")), QPdfDocument::NoError);
+
+    QPdfDiskCache cache(&document);
+    cache.setPath(directory.path());
+
+    // the stored images are found once the directory has been scanned
+    QTRY_VERIFY(cache.contains(1, imageSize));
+
+    QSignalSpy imageLoadedSpy(&cache, &QPdfDiskCache::imageLoaded);
+    QVERIFY(cache.requestImage(1, imageSize) != 0);
+    QTRY_COMPARE(imageLoadedSpy.count(), 1);
+    QCOMPARE(imageLoadedSpy[0][2].value<QImage>(), image);
+}
+
+void tst_QPdfDiskCache::maximumSize()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.diskcache.pdf")), QPdfDocument::NoError);
+
+    QPdfDiskCache cache(&document);
+    cache.setPath(directory.path());
+
+    QSignalSpy maximumSizeChangedSpy(&cache, &QPdfDiskCache::maximumSizeChanged);
+    cache.setMaximumSize(100 * 1024);
+    QCOMPARE(cache.maximumSize(), qint64(100 * 1024));
+    QCOMPARE(maximumSizeChangedSpy.count(), 1);
+
+    // each image takes 40 KiB, so only two of them fit
+    const QSize imageSize(100, 100);
+    for (int i = 0; i < 4; ++i) {
+        cache.insert(0, QSize(100, 100 + i), QImage(imageSize, QImage::Format_ARGB32));
+        QTRY_VERIFY(cache.contains(0, QSize(100, 100 + i)));
+
+        // the eviction goes by modification time
+        QTest::qWait(20);
+    }
+
+    QTRY_VERIFY(!cache.contains(0, QSize(100, 101)));
+    QVERIFY(!cache.contains(0, QSize(100, 100)));
+    QVERIFY(cache.contains(0, QSize(100, 102)));
+    QVERIFY(cache.contains(0, QSize(100, 103)));
+
+    // nothing is stored without a budget
+    cache.setMaximumSize(0);
+    QTRY_VERIFY(!cache.contains(0, QSize(100, 103)));
+    cache.insert(1, imageSize, QImage(imageSize, QImage::Format_ARGB32));
+    QTest::qWait(50);
+    QVERIFY(!cache.contains(1, imageSize));
+}
+
+void tst_QPdfDiskCache::clear()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.diskcache.pdf")), QPdfDocument::NoError);
+
+    QPdfDiskCache cache(&document);
+    cache.setPath(directory.path());
+
+    const QSize imageSize(100, 100);
+    cache.insert(0, imageSize, QImage(imageSize, QImage::Format_ARGB32));
+    QTRY_VERIFY(cache.contains(0, imageSize));
+
+    cache.clear();
+    QTRY_VERIFY(!cache.contains(0, imageSize));
+    QCOMPARE(QDir(directory.path()).entryList(QDir::AllEntries | QDir::NoDotAndDotDot), QStringList());
+}
+
+QTEST_MAIN(tst_QPdfDiskCache)
+
+#include "tst_qpdfdiskcache.moc"
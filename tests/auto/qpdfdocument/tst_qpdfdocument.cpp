@@ -44,6 +44,8 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QTcpServer>
+#include <QTcpSocket>
 
 class tst_QPdfDocument: public QObject
 {
@@ -58,14 +60,28 @@ public:
 private slots:
     void pageCount();
     void loadFromIODevice();
+    void loadFromFileMatchesIODevice();
     void loadAsync();
     void password();
     void close();
     void loadAfterClose();
+    void loadAfterFailedLoad();
     void closeOnDestroy();
     void status();
     void passwordClearedOnClose();
     void metaData();
+    void pageCache();
+    void progressiveLoading();
+    void rangeRequests();
+    void pageAvailable();
+    void rangeRequestErrors();
+    void spoolToDisk();
+    void renderIntoImage();
+    void bitmapPool();
+    void renderTiles();
+    void renderInterruptible();
+    void renderImageFormats_data();
+    void renderImageFormats();
 };
 
 struct TemporaryPdf: public QTemporaryFile
@@ -97,6 +113,78 @@ TemporaryPdf::TemporaryPdf()
     seek(0);
 }
 
+// Serves a single document over HTTP and honours "Range: bytes=<first>-<last>"
+class RangeHttpServer : public QTcpServer
+{
+public:
+    explicit RangeHttpServer(const QByteArray &data)
+        : m_data(data)
+        , rangeRequestCount(0)
+        , failingRangeRequests(0)
+    {
+        connect(this, &QTcpServer::newConnection, this, &RangeHttpServer::acceptConnections);
+        listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url() const { return QUrl(QStringLiteral("http://127.0.0.1:%1/document.pdf").arg(serverPort())); }
+
+    int rangeRequestCount;
+    int failingRangeRequests; // answered with an error
+
+private:
+    void acceptConnections()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    }
+
+    void handleRequest(QTcpSocket *socket)
+    {
+        QByteArray &request = m_requests[socket];
+        request += socket->readAll();
+        if (!request.contains("\r\n\r\n"))
+            return;
+
+        qint64 first = 0;
+        qint64 last = m_data.size() - 1;
+        bool partial = false;
+
+        const int rangeStart = request.indexOf("Range: bytes=");
+        if (rangeStart >= 0) {
+            const int valueStart = rangeStart + int(qstrlen("Range: bytes="));
+            const QList<QByteArray> range = request.mid(valueStart, request.indexOf("\r\n", valueStart) - valueStart).split('-');
+            first = range.at(0).toLongLong();
+            last = qMin(last, range.at(1).toLongLong());
+            partial = true;
+            ++rangeRequestCount;
+
+            if (failingRangeRequests > 0) {
+                --failingRangeRequests;
+                m_requests.remove(socket);
+                socket->write("HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+                socket->disconnectFromHost();
+                return;
+            }
+        }
+
+        QByteArray response = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+        response += "Accept-Ranges: bytes\r\nConnection: close\r\nContent-Type: application/pdf\r\n";
+        if (partial)
+            response += "Content-Range: bytes " + QByteArray::number(first) + '-' + QByteArray::number(last) + '/' + QByteArray::number(m_data.size()) + "\r\n";
+        response += "Content-Length: " + QByteArray::number(last - first + 1) + "\r\n\r\n";
+        response += m_data.mid(int(first), int(last - first + 1));
+
+        m_requests.remove(socket);
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+    QByteArray m_data;
+    QHash<QTcpSocket*, QByteArray> m_requests;
+};
+
 void tst_QPdfDocument::pageCount()
 {
     TemporaryPdf tempPdf;
@@ -111,6 +199,15 @@ void tst_QPdfDocument::pageCount()
     QCOMPARE(pageCountChangedSpy[0][0].toInt(), doc.pageCount());
 
     QCOMPARE(doc.pageSize(0).toSize(), tempPdf.pageLayout.fullRectPoints().size());
+
+    const QVector<QSizeF> pageSizes = doc.pageSizes();
+    QCOMPARE(pageSizes.size(), doc.pageCount());
+    for (int page = 0; page < doc.pageCount(); ++page)
+        QCOMPARE(pageSizes.at(page), doc.pageSize(page));
+    QVERIFY(!doc.pageSize(doc.pageCount()).isValid());
+
+    doc.close();
+    QVERIFY(doc.pageSizes().isEmpty());
 }
 
 void tst_QPdfDocument::loadFromIODevice()
@@ -129,6 +226,24 @@ void tst_QPdfDocument::loadFromIODevice()
     QCOMPARE(pageCountChangedSpy[0][0].toInt(), doc.pageCount());
 }
 
+void tst_QPdfDocument::loadFromFileMatchesIODevice()
+{
+    TemporaryPdf tempPdf;
+
+    QPdfDocument fileDocument;
+    QCOMPARE(fileDocument.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    QPdfDocument deviceDocument;
+    deviceDocument.load(&tempPdf);
+    QCOMPARE(deviceDocument.status(), QPdfDocument::Ready);
+
+    QCOMPARE(fileDocument.pageCount(), deviceDocument.pageCount());
+    for (int page = 0; page < fileDocument.pageCount(); ++page) {
+        QCOMPARE(fileDocument.pageSize(page), deviceDocument.pageSize(page));
+        QCOMPARE(fileDocument.render(page, QSize(200, 300)), deviceDocument.render(page, QSize(200, 300)));
+    }
+}
+
 void tst_QPdfDocument::loadAsync()
 {
     TemporaryPdf tempPdf;
@@ -234,6 +349,26 @@ void tst_QPdfDocument::loadAfterClose()
     QCOMPARE(pageCountChangedSpy[0][0].toInt(), doc.pageCount());
 }
 
+void tst_QPdfDocument::loadAfterFailedLoad()
+{
+    QPdfDocument doc;
+
+    // the file is mapped, but no document is opened from it
+    QCOMPARE(doc.load(QFINDTESTDATA("pdf-sample.protected.pdf")), QPdfDocument::IncorrectPasswordError);
+    QCOMPARE(doc.status(), QPdfDocument::Error);
+
+    TemporaryPdf tempPdf;
+    doc.load(&tempPdf);
+    QCOMPARE(doc.status(), QPdfDocument::Ready);
+    QCOMPARE(doc.error(), QPdfDocument::NoError);
+    QCOMPARE(doc.pageCount(), 2);
+    QCOMPARE(doc.pageSize(0).toSize(), tempPdf.pageLayout.fullRectPoints().size());
+
+    QPdfDocument reference;
+    reference.load(&tempPdf);
+    QCOMPARE(doc.render(1, QSize(200, 300)), reference.render(1, QSize(200, 300)));
+}
+
 void tst_QPdfDocument::closeOnDestroy()
 {
     TemporaryPdf tempPdf;
@@ -381,6 +516,413 @@ void tst_QPdfDocument::metaData()
     QCOMPARE(doc.metaData(QPdfDocument::ModificationDate).toDateTime(), QDateTime(QDate(2016, 8, 8), QTime(8, 3, 6), Qt::UTC));
 }
 
+void tst_QPdfDocument::pageCache()
+{
+    TemporaryPdf tempPdf;
+    QPdfDocument doc;
+
+    QVERIFY(doc.pageCacheLimit() > 0);
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    const QSize imageSize(200, 300);
+    const QImage uncached = doc.render(0, imageSize);
+    QVERIFY(!uncached.isNull());
+
+    // rendering a cached page gives the same result
+    QCOMPARE(doc.render(0, imageSize), uncached);
+    QCOMPARE(doc.render(0, imageSize * 2).size(), imageSize * 2);
+
+    doc.releasePage(0);
+    QCOMPARE(doc.render(0, imageSize), uncached);
+
+    doc.setPageCacheLimit(1);
+    QCOMPARE(doc.pageCacheLimit(), 1);
+    QCOMPARE(doc.render(1, imageSize).size(), imageSize);
+    QCOMPARE(doc.render(0, imageSize), uncached);
+
+    doc.releaseAllPages();
+    doc.setPageCacheLimit(0);
+    QCOMPARE(doc.pageCacheLimit(), 0);
+    QCOMPARE(doc.render(0, imageSize), uncached);
+}
+
+void tst_QPdfDocument::progressiveLoading()
+{
+    TemporaryPdf tempPdf;
+
+    QNetworkAccessManager nam;
+
+    QUrl url = QUrl::fromLocalFile(tempPdf.fileName());
+    QScopedPointer<QNetworkReply> reply(nam.get(QNetworkRequest(url)));
+
+    QPdfDocument doc;
+    QVERIFY(!doc.progressiveLoading());
+    doc.setProgressiveLoading(true);
+    QVERIFY(doc.progressiveLoading());
+
+    QSignalSpy statusChangedSpy(&doc, SIGNAL(statusChanged(QPdfDocument::Status)));
+
+    QVERIFY(!doc.isPageAvailable(0));
+
+    doc.load(reply.data());
+
+    QTRY_COMPARE(doc.status(), QPdfDocument::Ready);
+    QCOMPARE(statusChangedSpy.count(), 2);
+    QCOMPARE(doc.pageCount(), 2);
+    QVERIFY(doc.isPageAvailable(0));
+    QTRY_VERIFY(doc.isPageAvailable(1));
+    QVERIFY(!doc.isPageAvailable(2));
+    QVERIFY(!doc.isPageAvailable(-1));
+    QCOMPARE(doc.pageSize(1).toSize(), tempPdf.pageLayout.fullRectPoints().size());
+    QVERIFY(!doc.render(1, QSize(100, 100)).isNull());
+
+    doc.close();
+    QVERIFY(!doc.isPageAvailable(0));
+}
+
+void tst_QPdfDocument::rangeRequests()
+{
+    TemporaryPdf tempPdf;
+
+    RangeHttpServer server(tempPdf.readAll());
+    QVERIFY(server.isListening());
+
+    QNetworkAccessManager nam;
+    QNetworkReply *reply = nam.get(QNetworkRequest(server.url()));
+
+    QPdfDocument doc;
+    doc.setProgressiveLoading(true);
+    doc.load(reply);
+
+    QTRY_COMPARE(doc.status(), QPdfDocument::Ready);
+    QVERIFY(server.rangeRequestCount > 0);
+    QCOMPARE(doc.pageCount(), 2);
+    QVERIFY(doc.isPageAvailable(0));
+    QVERIFY(!doc.render(0, QSize(100, 100)).isNull());
+
+    // pages that are asked for are fetched on demand
+    doc.requestPage(1);
+    QTRY_VERIFY(doc.isPageAvailable(1));
+    QCOMPARE(doc.pageSize(1).toSize(), tempPdf.pageLayout.fullRectPoints().size());
+    QVERIFY(!doc.render(1, QSize(100, 100)).isNull());
+
+    delete reply;
+}
+
+void tst_QPdfDocument::pageAvailable()
+{
+    // every page holds an image of noise, which does not compress, so that the pages lie
+    // far enough apart in the file to be fetched with range requests of their own
+    const int pageCount = 4;
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    {
+        QPrinter printer;
+        printer.setOutputFormat(QPrinter::PdfFormat);
+        printer.setOutputFileName(file.fileName());
+
+        QPainter painter(&printer);
+        QImage noise(400, 400, QImage::Format_RGB32);
+        for (int page = 0; page < pageCount; ++page) {
+            if (page > 0)
+                printer.newPage();
+
+            for (int y = 0; y < noise.height(); ++y) {
+                for (int x = 0; x < noise.width(); ++x)
+                    noise.setPixel(x, y, qrand());
+            }
+            painter.drawImage(QRect(0, 0, 400, 400), noise);
+        }
+    }
+
+    RangeHttpServer server(file.readAll());
+    QVERIFY(server.isListening());
+
+    QNetworkAccessManager nam;
+    QNetworkReply *reply = nam.get(QNetworkRequest(server.url()));
+
+    QPdfDocument doc;
+    doc.setProgressiveLoading(true);
+
+    QSignalSpy pageAvailableSpy(&doc, &QPdfDocument::pageAvailable);
+
+    doc.load(reply);
+
+    QTRY_COMPARE(doc.status(), QPdfDocument::Ready);
+    QCOMPARE(doc.pageCount(), pageCount);
+    QVERIFY(doc.isPageAvailable(0));
+    QCOMPARE(pageAvailableSpy.count(), 0);
+
+    // asking does not fetch anything, requesting does, and only the requested page arrives
+    for (int page = pageCount - 1; page > 0; --page) {
+        QVERIFY(!doc.isPageAvailable(page));
+        QTest::qWait(100);
+        QVERIFY(!doc.isPageAvailable(page));
+        QCOMPARE(pageAvailableSpy.count(), pageCount - page - 1);
+
+        doc.requestPage(page);
+        QTRY_COMPARE(pageAvailableSpy.count(), pageCount - page);
+        QCOMPARE(pageAvailableSpy.last().at(0).toInt(), page);
+        QVERIFY(doc.isPageAvailable(page));
+
+        for (int missingPage = 1; missingPage < page; ++missingPage)
+            QVERIFY(!doc.isPageAvailable(missingPage));
+    }
+
+    QVERIFY(!doc.render(pageCount - 1, QSize(100, 100)).isNull());
+
+    delete reply;
+}
+
+void tst_QPdfDocument::rangeRequestErrors()
+{
+    TemporaryPdf tempPdf;
+    const QByteArray data = tempPdf.readAll();
+
+    QNetworkAccessManager nam;
+
+    {
+        // a transient error is overcome by sending the request again
+        RangeHttpServer server(data);
+        server.failingRangeRequests = 2;
+
+        QScopedPointer<QNetworkReply> reply(nam.get(QNetworkRequest(server.url())));
+
+        QPdfDocument doc;
+        doc.setProgressiveLoading(true);
+        doc.load(reply.data());
+
+        QTRY_COMPARE(doc.status(), QPdfDocument::Ready);
+        QCOMPARE(server.failingRangeRequests, 0);
+        QVERIFY(!doc.render(0, QSize(100, 100)).isNull());
+    }
+
+    {
+        // a server that keeps failing ends the loading
+        RangeHttpServer server(data);
+        server.failingRangeRequests = 1000;
+
+        QScopedPointer<QNetworkReply> reply(nam.get(QNetworkRequest(server.url())));
+
+        QPdfDocument doc;
+        doc.setProgressiveLoading(true);
+
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Range request failed"));
+        doc.load(reply.data());
+
+        QTRY_COMPARE(doc.status(), QPdfDocument::Error);
+    }
+}
+
+void tst_QPdfDocument::spoolToDisk()
+{
+    TemporaryPdf tempPdf;
+
+    QPdfDocument fileDocument;
+    QCOMPARE(fileDocument.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    QNetworkAccessManager nam;
+    QScopedPointer<QNetworkReply> reply(nam.get(QNetworkRequest(QUrl::fromLocalFile(tempPdf.fileName()))));
+
+    QPdfDocument doc;
+    QCOMPARE(doc.spoolThreshold(), qint64(-1));
+    doc.setSpoolThreshold(0);
+    QCOMPARE(doc.spoolThreshold(), qint64(0));
+
+    doc.load(reply.data());
+
+    QTRY_COMPARE(doc.status(), QPdfDocument::Ready);
+    QCOMPARE(doc.pageCount(), fileDocument.pageCount());
+    for (int page = 0; page < doc.pageCount(); ++page)
+        QCOMPARE(doc.render(page, QSize(200, 300)), fileDocument.render(page, QSize(200, 300)));
+}
+
+void tst_QPdfDocument::renderIntoImage()
+{
+    TemporaryPdf tempPdf;
+
+    QPdfDocument doc;
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    const QSize imageSize(200, 300);
+    const QImage expected = doc.render(0, imageSize);
+
+    QImage image(imageSize, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    QVERIFY(doc.render(0, &image));
+    QCOMPARE(image, expected);
+
+    QImage opaqueImage(imageSize, QImage::Format_RGB32);
+    QVERIFY(doc.render(0, &opaqueImage));
+    QCOMPARE(opaqueImage.pixel(0, 0), qRgb(255, 255, 255));
+
+    QImage unsupported(imageSize, QImage::Format_Mono);
+    QVERIFY(!doc.render(0, &unsupported));
+    QVERIFY(!doc.render(2, &image));
+
+    // a raw buffer with padding at the end of each line
+    const int bytesPerLine = imageSize.width() * 4 + 16;
+    QByteArray buffer(bytesPerLine * imageSize.height(), 0);
+    uchar *bits = reinterpret_cast<uchar *>(buffer.data());
+    QVERIFY(doc.render(0, bits, imageSize, bytesPerLine, QImage::Format_ARGB32));
+    QCOMPARE(QImage(bits, imageSize.width(), imageSize.height(), bytesPerLine, QImage::Format_ARGB32), expected);
+}
+
+void tst_QPdfDocument::bitmapPool()
+{
+    TemporaryPdf tempPdf;
+
+    QScopedPointer<QPdfDocument> doc(new QPdfDocument);
+    QCOMPARE(doc->bitmapPoolLimit(), qint64(0));
+    doc->setBitmapPoolLimit(10 * 1024 * 1024);
+    QCOMPARE(doc->bitmapPoolLimit(), qint64(10 * 1024 * 1024));
+    QCOMPARE(doc->load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    const QSize imageSize(200, 300);
+    QImage first = doc->render(0, imageSize);
+    const uchar *firstBuffer = first.constBits();
+    const QImage firstCopy = first.copy();
+    first = QImage();
+
+    // the buffer of the destroyed image is reused, and cleared before rendering
+    QImage second = doc->render(1, imageSize);
+    QCOMPARE(second.constBits(), firstBuffer);
+    QVERIFY(second != firstCopy);
+    QCOMPARE(doc->render(0, imageSize), firstCopy);
+
+    // images outlive the document
+    doc.reset();
+    QCOMPARE(second.size(), imageSize);
+    second = QImage();
+}
+
+void tst_QPdfDocument::renderTiles()
+{
+    TemporaryPdf tempPdf;
+
+    QPdfDocument doc;
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    const QSize imageSize(400, 600);
+    const QImage page = doc.render(0, imageSize);
+
+    QPdfDocumentRenderOptions options;
+    QCOMPARE(options.tileSize(), 0);
+    QVERIFY(options.tileRect().isNull());
+
+    options.setTile(QPoint(1, 2), 200);
+    QCOMPARE(options.tile(), QPoint(1, 2));
+    QCOMPARE(options.tileSize(), 256);
+    QCOMPARE(options.tileRect(), QRect(256, 512, 256, 256));
+
+    // tiles at the edges are clipped to the page image
+    const QImage tile = doc.render(0, imageSize, options);
+    QCOMPARE(tile.size(), QSize(144, 88));
+    QCOMPARE(tile, page.copy(256, 512, 144, 88));
+
+    options.setTile(QPoint(), 0);
+    QCOMPARE(options, QPdfDocumentRenderOptions());
+
+    // the last tile that can be represented still lies within the int range
+    options.setTile(QPoint(65535, 65535), 32768);
+    QCOMPARE(options.tileRect(), QRect(2147450880, 2147450880, 32768, 32768));
+
+    // tiles that cannot be represented are rejected instead of truncated
+    QTest::ignoreMessage(QtWarningMsg, "QPdfDocumentRenderOptions: Tile QPoint(65536,0) is out of range");
+    options.setTile(QPoint(65536, 0), 256);
+    QCOMPARE(options, QPdfDocumentRenderOptions());
+
+    QTest::ignoreMessage(QtWarningMsg, "QPdfDocumentRenderOptions: Unsupported tile size 65536");
+    options.setTile(QPoint(1, 2), 65536);
+    QCOMPARE(options, QPdfDocumentRenderOptions());
+
+    const QSizeF pageSize = doc.pageSize(0);
+    const QRect clip(100, 150, 120, 80);
+    const QImage region = doc.renderRegion(0, 2.0, clip);
+    QCOMPARE(region.size(), clip.size());
+    QCOMPARE(region, doc.render(0, (pageSize * 2.0).toSize()).copy(clip));
+
+    QVERIFY(doc.renderRegion(0, 2.0, QRect(-100, -100, 50, 50)).isNull());
+    QVERIFY(doc.renderRegion(2, 2.0, clip).isNull());
+}
+
+void tst_QPdfDocument::renderInterruptible()
+{
+    TemporaryPdf tempPdf;
+
+    QPdfDocument doc;
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    const QSize imageSize(200, 300);
+    const QImage expected = doc.render(0, imageSize);
+
+    QAtomicInt cancelled(0);
+    bool complete = false;
+    QCOMPARE(doc.render(0, imageSize, QPdfDocumentRenderOptions(), QDeadlineTimer(QDeadlineTimer::Forever), &cancelled, &complete), expected);
+    QVERIFY(complete);
+
+    cancelled.store(1);
+    QVERIFY(doc.render(0, imageSize, QPdfDocumentRenderOptions(), QDeadlineTimer(QDeadlineTimer::Forever), &cancelled, &complete).isNull());
+    QVERIFY(!complete);
+
+    // an expired deadline still delivers an image of the requested size
+    const QImage partial = doc.render(0, imageSize, QPdfDocumentRenderOptions(), QDeadlineTimer(0), nullptr, &complete);
+    QCOMPARE(partial.size(), imageSize);
+    QVERIFY(complete || partial != expected);
+}
+
+void tst_QPdfDocument::renderImageFormats_data()
+{
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<bool>("opaque");
+
+    QTest::newRow("ARGB32") << QImage::Format_ARGB32 << false;
+    QTest::newRow("ARGB32_Premultiplied") << QImage::Format_ARGB32_Premultiplied << false;
+    QTest::newRow("RGB32") << QImage::Format_RGB32 << true;
+    QTest::newRow("Grayscale8") << QImage::Format_Grayscale8 << true;
+    QTest::newRow("RGB888") << QImage::Format_RGB888 << true;
+}
+
+void tst_QPdfDocument::renderImageFormats()
+{
+    QFETCH(QImage::Format, format);
+    QFETCH(bool, opaque);
+
+    TemporaryPdf tempPdf;
+
+    QPdfDocument doc;
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    QPdfDocumentRenderOptions options;
+    QCOMPARE(options.imageFormat(), QImage::Format_ARGB32);
+    options.setImageFormat(format);
+    QCOMPARE(options.imageFormat(), format);
+
+    const QSize imageSize(200, 300);
+    const QImage image = doc.render(0, imageSize, options);
+    QCOMPARE(image.format(), format);
+    QCOMPARE(image.size(), imageSize);
+
+    // compared against the default output on the same background
+    QImage reference(imageSize, QImage::Format_ARGB32_Premultiplied);
+    reference.fill(opaque ? Qt::white : Qt::transparent);
+    {
+        QPainter painter(&reference);
+        painter.drawImage(0, 0, doc.render(0, imageSize));
+    }
+
+    QImage converted = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    if (format == QImage::Format_Grayscale8)
+        reference = reference.convertToFormat(QImage::Format_Grayscale8).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    QCOMPARE(converted.pixel(0, 0), reference.pixel(0, 0));
+    QCOMPARE(converted.pixel(110, 95), reference.pixel(110, 95));
+
+    options.setImageFormat(QImage::Format_Mono);
+    QCOMPARE(options.imageFormat(), QImage::Format_ARGB32);
+}
+
 QTEST_MAIN(tst_QPdfDocument)
 
 #include "tst_qpdfdocument.moc"
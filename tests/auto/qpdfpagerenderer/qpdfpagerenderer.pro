@@ -3,3 +3,7 @@ TARGET = tst_qpdfpagerenderer
 QT += pdf testlib network
 macos:CONFIG -= app_bundle
 SOURCES += tst_qpdfpagerenderer.cpp
+
+# the tests use the render helper of the build tree, which is not installed yet
+load(qt_build_paths)
+DEFINES += QTPDF_RENDER_PROCESS_DIR=\\\"$$MODULE_BASE_OUTDIR/libexec\\\"
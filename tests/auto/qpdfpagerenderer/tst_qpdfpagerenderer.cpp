@@ -36,28 +36,88 @@
 
 #include <QPdfDocument>
 #include <QPdfPageRenderer>
+#include <QPdfRenderCache>
+#include <QPdfRenderStatistics>
 
 #include <QtTest/QtTest>
 
+#include <numeric>
+
 class tst_QPdfPageRenderer: public QObject
 {
     Q_OBJECT
 
 private slots:
+    void initTestCase();
     void defaultValues();
     void withNoDocument();
     void withEmptyDocument();
     void withLoadedDocumentSingleThreaded();
     void withLoadedDocumentMultiThreaded();
+    void withLoadedDocumentMultiProcess();
+    void withLoadedDocumentThreadPool();
     void switchingRenderMode();
+    void renderTimeBudget();
+    void requestPriorities();
+    void cancelRequests();
+    void supersedeRequests();
+    void statistics();
 };
 
+// writes a page made of many small path objects, which PDFium renders in several steps
+static bool writeHeavyPdf(QIODevice *device)
+{
+    QByteArray content;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x)
+            content += QByteArray::number(2 * x) + ' ' + QByteArray::number(2 * y) + " 2 2 re f\n";
+    }
+
+    const QList<QByteArray> objects = {
+        "<< /Type /Catalog /Pages 2 0 R >>",
+        "<< /Type /Pages /Kids [3 0 R] /Count 1 >>",
+        "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] /Contents 4 0 R >>",
+        "<< /Length " + QByteArray::number(content.size()) + " >>\nstream\n" + content + "endstream"
+    };
+
+    QByteArray pdf = "%PDF-1.4\n";
+    QVector<int> offsets;
+    for (int i = 0; i < objects.size(); ++i) {
+        offsets.append(pdf.size());
+        pdf += QByteArray::number(i + 1) + " 0 obj\n" + objects.at(i) + "\nendobj\n";
+    }
+
+    const int xrefOffset = pdf.size();
+    pdf += "xref\n0 " + QByteArray::number(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (int offset : offsets)
+        pdf += QByteArray::number(offset).rightJustified(10, '0') + " 00000 n \n";
+    pdf += "trailer\n<< /Size " + QByteArray::number(objects.size() + 1) + " /Root 1 0 R >>\n";
+    pdf += "startxref\n" + QByteArray::number(xrefOffset) + "\n%%EOF\n";
+
+    return device->write(pdf) == pdf.size();
+}
+
+void tst_QPdfPageRenderer::initTestCase()
+{
+    // the helper of the build tree is used unless another one has been set up
+#ifdef Q_OS_WIN
+    const QString helper = QStringLiteral(QTPDF_RENDER_PROCESS_DIR "/QtPdfRenderProcess.exe");
+#else
+    const QString helper = QStringLiteral(QTPDF_RENDER_PROCESS_DIR "/QtPdfRenderProcess");
+#endif
+    if (qEnvironmentVariableIsEmpty("QTPDF_RENDER_PROCESS_PATH") && QFileInfo(helper).isExecutable())
+        qputenv("QTPDF_RENDER_PROCESS_PATH", QFile::encodeName(helper));
+}
+
 void tst_QPdfPageRenderer::defaultValues()
 {
     QPdfPageRenderer pageRenderer;
 
     QCOMPARE(pageRenderer.document(), nullptr);
     QCOMPARE(pageRenderer.renderMode(), QPdfPageRenderer::SingleThreadedRenderMode);
+    QCOMPARE(pageRenderer.renderTimeBudget(), -1);
+    QCOMPARE(pageRenderer.supersedeRequests(), false);
+    QCOMPARE(pageRenderer.statisticsInterval(), 0);
 }
 
 void tst_QPdfPageRenderer::withNoDocument()
@@ -127,6 +187,86 @@ void tst_QPdfPageRenderer::withLoadedDocumentMultiThreaded()
     QCOMPARE(pageRenderedSpy[0][4].toULongLong(), requestId);
 }
 
+void tst_QPdfPageRenderer::withLoadedDocumentMultiProcess()
+{
+    QPdfDocument document;
+
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::MultiProcessRenderMode);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    const QSize imageSize(100, 100);
+    const quint64 requestId = pageRenderer.requestPage(0, imageSize);
+
+    QCOMPARE(requestId, quint64(1));
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QCOMPARE(pageRenderedSpy[0][0].toInt(), 0);
+    QCOMPARE(pageRenderedSpy[0][1].toSize(), imageSize);
+    QCOMPARE(pageRenderedSpy[0][2].value<QImage>(), document.render(0, imageSize));
+    QCOMPARE(pageRenderedSpy[0][4].toULongLong(), requestId);
+}
+
+void tst_QPdfPageRenderer::withLoadedDocumentThreadPool()
+{
+    QPdfDocument document;
+
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::ThreadPoolRenderMode);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    const QSize imageSize(100, 100);
+    QVector<quint64> requestIds;
+    for (int page = 0; page < document.pageCount(); ++page)
+        requestIds.append(pageRenderer.requestPage(page, imageSize));
+
+    QTRY_COMPARE(pageRenderedSpy.count(), document.pageCount());
+
+    for (const auto &arguments : qAsConst(pageRenderedSpy)) {
+        const int page = arguments[0].toInt();
+        QCOMPARE(arguments[1].toSize(), imageSize);
+        QCOMPARE(arguments[2].value<QImage>(), document.render(page, imageSize));
+        QCOMPARE(arguments[4].toULongLong(), requestIds.at(page));
+    }
+
+    // switching back finishes the requests that are left in the queue
+    pageRenderedSpy.clear();
+    pageRenderer.requestPage(0, QSize(200, 200));
+    pageRenderer.requestPage(1, QSize(200, 200));
+    pageRenderer.setRenderMode(QPdfPageRenderer::SingleThreadedRenderMode);
+    QTRY_COMPARE(pageRenderedSpy.count(), 2);
+
+    // switching away interrupts the pages that are being rendered and renders them again,
+    // without delivering the interrupted images
+    QTemporaryFile heavyPdf;
+    QVERIFY(heavyPdf.open());
+    QVERIFY(writeHeavyPdf(&heavyPdf));
+    heavyPdf.close();
+    QCOMPARE(document.load(heavyPdf.fileName()), QPdfDocument::NoError);
+
+    const QSize heavyImageSize(1000, 1000);
+    const QImage heavyImage = document.render(0, heavyImageSize);
+
+    pageRenderer.setRenderMode(QPdfPageRenderer::ThreadPoolRenderMode);
+    pageRenderedSpy.clear();
+    const int requestCount = qMax(1, QThread::idealThreadCount());
+    for (int i = 0; i < requestCount; ++i)
+        pageRenderer.requestPage(0, heavyImageSize);
+    QTest::qWait(10);
+    pageRenderer.setRenderMode(QPdfPageRenderer::SingleThreadedRenderMode);
+
+    QTRY_COMPARE(pageRenderedSpy.count(), requestCount);
+    for (const auto &arguments : qAsConst(pageRenderedSpy))
+        QCOMPARE(arguments[2].value<QImage>(), heavyImage);
+}
+
 void tst_QPdfPageRenderer::switchingRenderMode()
 {
     QPdfDocument document;
@@ -179,6 +319,229 @@ void tst_QPdfPageRenderer::switchingRenderMode()
     QCOMPARE(pageRenderedSpy[0][4].toULongLong(), thirdRequestId);
 }
 
+void tst_QPdfPageRenderer::renderTimeBudget()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::MultiThreadedRenderMode);
+
+    QSignalSpy renderTimeBudgetChangedSpy(&pageRenderer, &QPdfPageRenderer::renderTimeBudgetChanged);
+    pageRenderer.setRenderTimeBudget(5000);
+    QCOMPARE(pageRenderer.renderTimeBudget(), 5000);
+    QCOMPARE(renderTimeBudgetChangedSpy.count(), 1);
+    pageRenderer.setRenderTimeBudget(5000);
+    QCOMPARE(renderTimeBudgetChangedSpy.count(), 1);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    const QSize imageSize(100, 100);
+    pageRenderer.requestPage(0, imageSize);
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QCOMPARE(pageRenderedSpy[0][2].value<QImage>(), document.render(0, imageSize));
+
+    // an exhausted budget delivers a partial image, which must not be cached
+    QTemporaryFile heavyPdf;
+    QVERIFY(heavyPdf.open());
+    QVERIFY(writeHeavyPdf(&heavyPdf));
+    heavyPdf.close();
+    QCOMPARE(document.load(heavyPdf.fileName()), QPdfDocument::NoError);
+
+    QPdfRenderCache renderCache(&document);
+    pageRenderer.setRenderCache(&renderCache);
+    pageRenderer.setRenderTimeBudget(0);
+
+    const QImage fullImage = document.render(0, imageSize);
+    QVERIFY(!fullImage.isNull());
+
+    pageRenderedSpy.clear();
+    pageRenderer.requestPage(0, imageSize);
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    const QImage partialImage = pageRenderedSpy[0][2].value<QImage>();
+    QCOMPARE(partialImage.size(), imageSize);
+    QVERIFY(partialImage != fullImage);
+    QCOMPARE(renderCache.count(), 0);
+
+    // a render that is cancelled while running is dropped
+    pageRenderedSpy.clear();
+    const quint64 requestId = pageRenderer.requestPage(0, imageSize * 2);
+    QVERIFY(pageRenderer.cancelRequest(requestId));
+    QTest::qWait(100);
+    QCOMPARE(pageRenderedSpy.count(), 0);
+    QCOMPARE(renderCache.count(), 0);
+}
+
+void tst_QPdfPageRenderer::requestPriorities()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    // the first request is handed out right away, the others wait in the queue
+    const quint64 first = pageRenderer.requestPage(0, QSize(100, 100), QPdfDocumentRenderOptions(), QPdfPageRenderer::BackgroundPriority);
+    const quint64 background = pageRenderer.requestPage(0, QSize(110, 110), QPdfDocumentRenderOptions(), QPdfPageRenderer::BackgroundPriority);
+    const quint64 prefetch = pageRenderer.requestPage(0, QSize(120, 120), QPdfDocumentRenderOptions(), QPdfPageRenderer::PrefetchPriority);
+    const quint64 visible = pageRenderer.requestPage(0, QSize(130, 130));
+
+    // requesting the same again raises the priority of the queued request
+    QCOMPARE(pageRenderer.requestPage(0, QSize(110, 110)), background);
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 4);
+    QCOMPARE(pageRenderedSpy[0][4].toULongLong(), first);
+    QCOMPARE(pageRenderedSpy[1][4].toULongLong(), visible);
+    QCOMPARE(pageRenderedSpy[2][4].toULongLong(), background);
+    QCOMPARE(pageRenderedSpy[3][4].toULongLong(), prefetch);
+}
+
+void tst_QPdfPageRenderer::cancelRequests()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::MultiThreadedRenderMode);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    const quint64 first = pageRenderer.requestPage(0, QSize(100, 100));
+    const quint64 second = pageRenderer.requestPage(0, QSize(200, 200));
+    const quint64 third = pageRenderer.requestPage(0, QSize(300, 300));
+
+    QVERIFY(pageRenderer.cancelRequest(first));
+    QVERIFY(pageRenderer.cancelRequest(second));
+    QVERIFY(!pageRenderer.cancelRequest(second));
+    QVERIFY(!pageRenderer.cancelRequest(12345));
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QCOMPARE(pageRenderedSpy[0][4].toULongLong(), third);
+
+    // a cancelled request can be made again
+    pageRenderedSpy.clear();
+    const quint64 fourth = pageRenderer.requestPage(0, QSize(200, 200));
+    QVERIFY(fourth != second);
+    pageRenderer.requestPage(0, QSize(400, 400));
+    pageRenderer.cancelAll();
+    QTest::qWait(100);
+    QCOMPARE(pageRenderedSpy.count(), 0);
+
+    pageRenderer.requestPage(0, QSize(100, 100));
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+}
+
+void tst_QPdfPageRenderer::supersedeRequests()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::MultiThreadedRenderMode);
+
+    QSignalSpy supersedeRequestsChangedSpy(&pageRenderer, &QPdfPageRenderer::supersedeRequestsChanged);
+    pageRenderer.setSupersedeRequests(true);
+    QCOMPARE(pageRenderer.supersedeRequests(), true);
+    QCOMPARE(supersedeRequestsChangedSpy.count(), 1);
+    pageRenderer.setSupersedeRequests(true);
+    QCOMPARE(supersedeRequestsChangedSpy.count(), 1);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    // the first request is handed to the worker immediately and is not superseded
+    const quint64 first = pageRenderer.requestPage(0, QSize(100, 100));
+    pageRenderer.requestPage(0, QSize(200, 200));
+    pageRenderer.requestPage(0, QSize(300, 300));
+    const quint64 other = pageRenderer.requestPage(1, QSize(300, 300));
+    const quint64 last = pageRenderer.requestPage(0, QSize(400, 400));
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 3);
+    QTest::qWait(100);
+    QCOMPARE(pageRenderedSpy.count(), 3);
+
+    QSet<quint64> renderedIds;
+    for (const auto &arguments : qAsConst(pageRenderedSpy))
+        renderedIds.insert(arguments[4].toULongLong());
+    QCOMPARE(renderedIds, QSet<quint64>() << first << other << last);
+}
+
+void tst_QPdfPageRenderer::statistics()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::MultiThreadedRenderMode);
+
+    QPdfRenderStatistics statistics = pageRenderer.statistics();
+    QCOMPARE(statistics.requestCount(), quint64(0));
+    QCOMPARE(statistics.queuedRequests(), 0);
+    QCOMPARE(statistics.pendingRequests(), 0);
+    QCOMPARE(statistics.histogram(QPdfRenderStatistics::Render).size(), 32);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    pageRenderer.requestPage(0, QSize(100, 100));
+    pageRenderer.requestPage(1, QSize(100, 100));
+    const quint64 cancelled = pageRenderer.requestPage(2, QSize(100, 100));
+
+    statistics = pageRenderer.statistics();
+    QCOMPARE(statistics.requestCount(), quint64(3));
+    QCOMPARE(statistics.pendingRequests(), 1);
+    QCOMPARE(statistics.queuedRequests(), 2);
+
+    QVERIFY(pageRenderer.cancelRequest(cancelled));
+    QTRY_COMPARE(pageRenderedSpy.count(), 2);
+
+    statistics = pageRenderer.statistics();
+    QCOMPARE(statistics.completedRequests(), quint64(2));
+    QCOMPARE(statistics.cancelledRequests(), quint64(1));
+    QCOMPARE(statistics.queuedRequests(), 0);
+    QCOMPARE(statistics.pendingRequests(), 0);
+    QVERIFY(statistics.throughput() > 0);
+    QVERIFY(statistics.averageTime(QPdfRenderStatistics::Render) > 0);
+
+    for (const auto stage : {QPdfRenderStatistics::QueueWait, QPdfRenderStatistics::Render, QPdfRenderStatistics::Delivery}) {
+        const QVector<quint64> histogram = statistics.histogram(stage);
+        QCOMPARE(std::accumulate(histogram.cbegin(), histogram.cend(), quint64(0)), quint64(2));
+    }
+
+    // the statistics are delivered periodically on request
+    QSignalSpy statisticsUpdatedSpy(&pageRenderer, &QPdfPageRenderer::statisticsUpdated);
+    pageRenderer.setStatisticsInterval(10);
+    QCOMPARE(pageRenderer.statisticsInterval(), 10);
+    QTRY_VERIFY(statisticsUpdatedSpy.count() >= 2);
+    QCOMPARE(statisticsUpdatedSpy.last().at(0).value<QPdfRenderStatistics>().completedRequests(), quint64(2));
+
+    pageRenderer.setStatisticsInterval(0);
+    statisticsUpdatedSpy.clear();
+    QTest::qWait(50);
+    QCOMPARE(statisticsUpdatedSpy.count(), 0);
+
+    pageRenderer.resetStatistics();
+    QCOMPARE(pageRenderer.statistics().requestCount(), quint64(0));
+    QCOMPARE(pageRenderer.statistics().completedRequests(), quint64(0));
+
+    // the statistics are an implicitly shared value type
+    QPdfRenderStatistics empty = pageRenderer.statistics();
+    empty.swap(statistics);
+    QCOMPARE(empty.completedRequests(), quint64(2));
+    QCOMPARE(statistics.completedRequests(), quint64(0));
+
+    QPdfRenderStatistics moved(std::move(empty));
+    QCOMPARE(moved.completedRequests(), quint64(2));
+    statistics = std::move(moved);
+    QCOMPARE(statistics.completedRequests(), quint64(2));
+}
+
 QTEST_MAIN(tst_QPdfPageRenderer)
 
 #include "tst_qpdfpagerenderer.moc"
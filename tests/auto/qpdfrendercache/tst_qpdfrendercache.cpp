@@ -0,0 +1,226 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QPdfDocument>
+#include <QPdfPageRenderer>
+#include <QPdfRenderCache>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfRenderCache: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaultValues();
+    void insertAndFind();
+    void findNearest();
+    void maximumSize();
+    void clearedOnDocumentChange();
+    void sharedWithPageRenderer();
+};
+
+void tst_QPdfRenderCache::defaultValues()
+{
+    QPdfRenderCache cache;
+
+    QCOMPARE(cache.document(), nullptr);
+    QCOMPARE(cache.maximumSize(), qint64(64 * 1024 * 1024));
+    QCOMPARE(cache.size(), qint64(0));
+    QCOMPARE(cache.count(), 0);
+}
+
+void tst_QPdfRenderCache::insertAndFind()
+{
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.rendercache.pdf")), QPdfDocument::NoError);
+
+    QPdfRenderCache cache(&document);
+    QCOMPARE(cache.document(), &document);
+
+    const QSize imageSize(100, 100);
+    QVERIFY(cache.image(0, imageSize).isNull());
+
+    const QImage image = cache.render(0, imageSize);
+    QCOMPARE(image.size(), imageSize);
+    QVERIFY(cache.contains(0, imageSize));
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.size(), qint64(40 * 1024)); // rounded up to whole KiB
+
+    // served from the cache, so the data is shared
+    QCOMPARE(cache.render(0, imageSize).constBits(), image.constBits());
+
+    // the options are part of the key
+    QPdfDocumentRenderOptions options;
+    options.setRotation(QPdf::Rotate90);
+    QVERIFY(!cache.contains(0, imageSize, options));
+    QVERIFY(!cache.contains(1, imageSize));
+
+    cache.insert(1, imageSize, QImage());
+    QCOMPARE(cache.count(), 1);
+
+    cache.insert(0, imageSize, image, options);
+    QCOMPARE(cache.count(), 2);
+
+    cache.remove(0, imageSize, options);
+    QVERIFY(cache.contains(0, imageSize));
+    QVERIFY(!cache.contains(0, imageSize, options));
+    QCOMPARE(cache.count(), 1);
+
+    cache.remove(0);
+    QVERIFY(!cache.contains(0, imageSize));
+    QCOMPARE(cache.count(), 0);
+}
+
+void tst_QPdfRenderCache::findNearest()
+{
+    QPdfRenderCache cache;
+
+    QImage small(50, 50, QImage::Format_ARGB32);
+    QImage medium(200, 200, QImage::Format_ARGB32);
+    QImage large(400, 400, QImage::Format_ARGB32);
+    cache.insert(0, small.size(), small);
+    cache.insert(0, medium.size(), medium);
+    cache.insert(0, large.size(), large);
+
+    // the smallest larger image is preferred, otherwise the largest smaller one
+    QCOMPARE(cache.findNearest(0, QSize(100, 100)).size(), medium.size());
+    QCOMPARE(cache.findNearest(0, QSize(300, 300)).size(), large.size());
+    QCOMPARE(cache.findNearest(0, QSize(800, 800)).size(), large.size());
+    QCOMPARE(cache.findNearest(0, QSize(10, 10)).size(), small.size());
+
+    QVERIFY(cache.findNearest(1, QSize(100, 100)).isNull());
+
+    QPdfDocumentRenderOptions options;
+    options.setRotation(QPdf::Rotate180);
+    QVERIFY(cache.findNearest(0, QSize(100, 100), options).isNull());
+
+    // tiles are only found in their exact size
+    QPdfDocumentRenderOptions tileOptions;
+    tileOptions.setTile(QPoint(0, 0), 256);
+    cache.insert(0, QSize(1024, 1024), QImage(256, 256, QImage::Format_ARGB32), tileOptions);
+    QVERIFY(cache.findNearest(0, QSize(512, 512), tileOptions).isNull());
+    QCOMPARE(cache.findNearest(0, QSize(1024, 1024), tileOptions).size(), QSize(256, 256));
+}
+
+void tst_QPdfRenderCache::maximumSize()
+{
+    QPdfRenderCache cache;
+
+    QSignalSpy maximumSizeChangedSpy(&cache, &QPdfRenderCache::maximumSizeChanged);
+    cache.setMaximumSize(1024 * 1024);
+    QCOMPARE(cache.maximumSize(), qint64(1024 * 1024));
+    QCOMPARE(maximumSizeChangedSpy.count(), 1);
+
+    // each image takes 400 KiB, so only two of them fit
+    const QSize imageSize(320, 320);
+    for (int page = 0; page < 4; ++page)
+        cache.insert(page, imageSize, QImage(imageSize, QImage::Format_ARGB32));
+
+    QCOMPARE(cache.count(), 2);
+    QVERIFY(cache.size() <= cache.maximumSize());
+    QVERIFY(!cache.contains(0, imageSize));
+    QVERIFY(cache.contains(3, imageSize));
+
+    // an image larger than the budget is not kept
+    cache.insert(4, QSize(1024, 1024), QImage(1024, 1024, QImage::Format_ARGB32));
+    QVERIFY(!cache.contains(4, QSize(1024, 1024)));
+
+    cache.setMaximumSize(0);
+    QCOMPARE(cache.count(), 0);
+}
+
+void tst_QPdfRenderCache::clearedOnDocumentChange()
+{
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.rendercache.pdf")), QPdfDocument::NoError);
+
+    QPdfRenderCache cache(&document);
+    cache.render(0, QSize(100, 100));
+    QCOMPARE(cache.count(), 1);
+
+    document.close();
+    QCOMPARE(cache.count(), 0);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.rendercache.pdf")), QPdfDocument::NoError);
+    cache.render(0, QSize(100, 100));
+    QCOMPARE(cache.count(), 1);
+
+    QSignalSpy documentChangedSpy(&cache, &QPdfRenderCache::documentChanged);
+    cache.setDocument(nullptr);
+    QCOMPARE(documentChangedSpy.count(), 1);
+    QCOMPARE(cache.count(), 0);
+}
+
+void tst_QPdfRenderCache::sharedWithPageRenderer()
+{
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.rendercache.pdf")), QPdfDocument::NoError);
+
+    QPdfRenderCache cache(&document);
+
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderCache(&cache);
+    QCOMPARE(pageRenderer.renderCache(), &cache);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    // rendered pages end up in the cache
+    const QSize imageSize(100, 100);
+    pageRenderer.requestPage(0, imageSize);
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QVERIFY(cache.contains(0, imageSize));
+
+    // and cached pages are not rendered again
+    const QImage image(imageSize, QImage::Format_ARGB32);
+    cache.insert(1, imageSize, image);
+    const quint64 requestId = pageRenderer.requestPage(1, imageSize);
+    QCOMPARE(pageRenderedSpy.count(), 1);
+    QTRY_COMPARE(pageRenderedSpy.count(), 2);
+    QCOMPARE(pageRenderedSpy[1][2].value<QImage>().constBits(), image.constBits());
+    QCOMPARE(pageRenderedSpy[1][4].toULongLong(), requestId);
+
+    // and can be cancelled until they are delivered
+    const quint64 cancelledId = pageRenderer.requestPage(1, imageSize);
+    QVERIFY(pageRenderer.cancelRequest(cancelledId));
+    QTest::qWait(50);
+    QCOMPARE(pageRenderedSpy.count(), 2);
+}
+
+QTEST_MAIN(tst_QPdfRenderCache)
+
+#include "tst_qpdfrendercache.moc"
@@ -0,0 +1,9 @@
+CONFIG += testcase
+TARGET = tst_qpdfrenderprocess
+QT += pdf-private testlib
+macos:CONFIG -= app_bundle
+SOURCES += tst_qpdfrenderprocess.cpp
+
+# the tests use the render helper of the build tree, which is not installed yet
+load(qt_build_paths)
+DEFINES += QTPDF_RENDER_PROCESS_DIR=\\\"$$MODULE_BASE_OUTDIR/libexec\\\"
@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtPdf/private/qpdfrenderprocess_p.h>
+
+#include <QPdfDocument>
+#include <QProcess>
+#include <QtTest/QtTest>
+
+class tst_QPdfRenderProcess: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void helperExecutable();
+    void renderPages();
+    void imageOutlivesPool();
+    void restartAfterCrash();
+    void requestTimeout();
+
+private:
+    QString m_fileName;
+    QPdfDocument m_document;
+};
+
+void tst_QPdfRenderProcess::initTestCase()
+{
+    // the helper of the build tree is used unless another one has been set up
+#ifdef Q_OS_WIN
+    const QString helper = QStringLiteral(QTPDF_RENDER_PROCESS_DIR "/QtPdfRenderProcess.exe");
+#else
+    const QString helper = QStringLiteral(QTPDF_RENDER_PROCESS_DIR "/QtPdfRenderProcess");
+#endif
+    if (qEnvironmentVariableIsEmpty("QTPDF_RENDER_PROCESS_PATH") && QFileInfo(helper).isExecutable())
+        qputenv("QTPDF_RENDER_PROCESS_PATH", QFile::encodeName(helper));
+
+    qRegisterMetaType<QPdfDocumentRenderOptions>();
+
+    m_fileName = QFINDTESTDATA("pdf-sample.renderprocess.pdf");
+    QCOMPARE(m_document.load(m_fileName), QPdfDocument::NoError);
+}
+
+void tst_QPdfRenderProcess::helperExecutable()
+{
+    QVERIFY(!QPdfRenderProcessPool::helperExecutable().isEmpty());
+
+    QPdfRenderProcessPool pool(1);
+    QCOMPARE(pool.processCount(), 1);
+    QVERIFY(pool.canRender(m_fileName));
+    QVERIFY(!pool.canRender(QString()));
+}
+
+void tst_QPdfRenderProcess::renderPages()
+{
+    QPdfRenderProcessPool pool(1);
+    QSignalSpy pageRenderedSpy(&pool, &QPdfRenderProcessPool::pageRendered);
+
+    // the segments of the images that are gone are reused for the later requests
+    const QVector<QSize> imageSizes = { QSize(100, 100), QSize(300, 200), QSize(50, 80), QSize(100, 100) };
+    for (int i = 0; i < imageSizes.size(); ++i)
+        pool.requestPage(i + 1, m_fileName, QByteArray(), i % m_document.pageCount(), imageSizes.at(i), QPdfDocumentRenderOptions());
+
+    QTRY_COMPARE(pageRenderedSpy.count(), imageSizes.size());
+
+    for (int i = 0; i < imageSizes.size(); ++i) {
+        const int page = i % m_document.pageCount();
+        QCOMPARE(pageRenderedSpy[i][0].toInt(), page);
+        QCOMPARE(pageRenderedSpy[i][1].toSize(), imageSizes.at(i));
+        QCOMPARE(pageRenderedSpy[i][2].value<QImage>(), m_document.render(page, imageSizes.at(i)));
+        QCOMPARE(pageRenderedSpy[i][4].toULongLong(), quint64(i + 1));
+    }
+}
+
+void tst_QPdfRenderProcess::imageOutlivesPool()
+{
+    QImage image;
+    const QSize imageSize(200, 200);
+
+    {
+        QPdfRenderProcessPool pool(1);
+        QSignalSpy pageRenderedSpy(&pool, &QPdfRenderProcessPool::pageRendered);
+
+        pool.requestPage(1, m_fileName, QByteArray(), 0, imageSize, QPdfDocumentRenderOptions());
+        QTRY_COMPARE(pageRenderedSpy.count(), 1);
+        image = pageRenderedSpy[0][2].value<QImage>();
+    }
+
+    // the image still points into its shared memory segment
+    QCOMPARE(image, m_document.render(0, imageSize));
+}
+
+void tst_QPdfRenderProcess::restartAfterCrash()
+{
+    QPdfRenderProcessPool pool(1);
+    QSignalSpy pageRenderedSpy(&pool, &QPdfRenderProcessPool::pageRendered);
+
+    const QSize imageSize(100, 100);
+    pool.requestPage(1, m_fileName, QByteArray(), 0, imageSize, QPdfDocumentRenderOptions());
+
+    // the helper is killed as soon as it has started and been handed the request
+    const QList<QProcess *> processes = pool.findChildren<QProcess *>();
+    QCOMPARE(processes.count(), 1);
+    QProcess *process = processes.first();
+    connect(process, &QProcess::started, process, [process]() { process->kill(); });
+
+    // the request is retried in a new helper
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QCOMPARE(pageRenderedSpy[0][2].value<QImage>(), m_document.render(0, imageSize));
+
+    pool.requestPage(2, m_fileName, QByteArray(), 1, imageSize, QPdfDocumentRenderOptions());
+    QTRY_COMPARE(pageRenderedSpy.count(), 2);
+    QCOMPARE(pageRenderedSpy[1][2].value<QImage>(), m_document.render(1, imageSize));
+}
+
+void tst_QPdfRenderProcess::requestTimeout()
+{
+    QPdfRenderProcessPool pool(1);
+    QSignalSpy pageRenderedSpy(&pool, &QPdfRenderProcessPool::pageRendered);
+
+    QCOMPARE(pool.requestTimeout(), 30000);
+
+    // the helper cannot start up in time, so both attempts are killed
+    pool.setRequestTimeout(1);
+    const QRegularExpression warning(QStringLiteral("Render process did not answer"));
+    QTest::ignoreMessage(QtWarningMsg, warning);
+    QTest::ignoreMessage(QtWarningMsg, warning);
+
+    const QSize imageSize(100, 100);
+    pool.requestPage(1, m_fileName, QByteArray(), 0, imageSize, QPdfDocumentRenderOptions());
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QVERIFY(pageRenderedSpy[0][2].value<QImage>().isNull());
+
+    // the pool recovers with a new helper
+    pool.setRequestTimeout(10000);
+    pool.requestPage(2, m_fileName, QByteArray(), 0, imageSize, QPdfDocumentRenderOptions());
+    QTRY_COMPARE(pageRenderedSpy.count(), 2);
+    QCOMPARE(pageRenderedSpy[1][2].value<QImage>(), m_document.render(0, imageSize));
+}
+
+QTEST_MAIN(tst_QPdfRenderProcess)
+
+#include "tst_qpdfrenderprocess.moc"
@@ -0,0 +1,3 @@
+TEMPLATE = subdirs
+
+qtHaveModule(printsupport): SUBDIRS += qpdfdocument
@@ -0,0 +1,4 @@
+TARGET = tst_bench_qpdfdocument
+QT += pdf printsupport testlib
+macx:CONFIG -= app_bundle
+SOURCES += tst_bench_qpdfdocument.cpp
@@ -0,0 +1,141 @@
+/****************************************************************************
+**
+** Copyright (C) 2017 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QPainter>
+#include <QPdfDocument>
+#include <QPrinter>
+#include <QTemporaryFile>
+#include <QThreadPool>
+
+#include <memory>
+#include <vector>
+
+class tst_QPdfDocumentBench: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void renderConcurrently_data();
+    void renderConcurrently();
+
+private:
+    QTemporaryFile m_pdfFile;
+};
+
+static const int pageCount = 8;
+
+class RenderTask : public QRunnable
+{
+public:
+    explicit RenderTask(QPdfDocument *document)
+        : m_document(document)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        for (int page = 0; page < m_document->pageCount(); ++page)
+            m_document->render(page, QSize(1240, 1754));
+    }
+
+private:
+    QPdfDocument *m_document;
+};
+
+void tst_QPdfDocumentBench::initTestCase()
+{
+    QVERIFY(m_pdfFile.open());
+
+    QPrinter printer;
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(m_pdfFile.fileName());
+    printer.setPageLayout(QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()));
+
+    QPainter painter(&printer);
+    for (int page = 0; page < pageCount; ++page) {
+        if (page > 0)
+            printer.newPage();
+
+        // enough vector content to make rasterization dominate over the locking overhead
+        for (int i = 0; i < 2000; ++i) {
+            painter.setPen(QColor::fromHsv((i * 7) % 360, 255, 200));
+            painter.drawLine(i % 500, (i * 13) % 800, (i * 17) % 500, (i * 3) % 800);
+        }
+        painter.drawText(100, 100, QStringLiteral("Benchmark Page %1").arg(page + 1));
+    }
+}
+
+void tst_QPdfDocumentBench::renderConcurrently_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    const int idealThreadCount = qMax(1, QThread::idealThreadCount());
+    for (int threadCount = 1; threadCount < idealThreadCount; threadCount *= 2)
+        QTest::addRow("%d threads", threadCount) << threadCount;
+    QTest::addRow("%d threads", idealThreadCount) << idealThreadCount;
+}
+
+// Every thread renders all pages of its own document. The amount of work per thread
+// is constant, so with per-document locking the wall time should stay roughly flat
+// while the number of threads (and therefore the page throughput) grows.
+void tst_QPdfDocumentBench::renderConcurrently()
+{
+    QFETCH(int, threadCount);
+
+    std::vector<std::unique_ptr<QPdfDocument>> documents;
+    for (int i = 0; i < threadCount; ++i) {
+        documents.emplace_back(new QPdfDocument);
+        QCOMPARE(documents.back()->load(m_pdfFile.fileName()), QPdfDocument::NoError);
+        QCOMPARE(documents.back()->pageCount(), pageCount);
+    }
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+
+    QBENCHMARK {
+        for (const auto &document : documents)
+            threadPool.start(new RenderTask(document.get()));
+        threadPool.waitForDone();
+    }
+}
+
+QTEST_MAIN(tst_QPdfDocumentBench)
+
+#include "tst_bench_qpdfdocument.moc"